@@ -0,0 +1,32 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+/// Number of global operator new calls made so far.
+size_t allocationCount();
+
+/*!
+ * Counts heap allocations made while benchmarking, and reports them as
+ * the "allocs" counter averaged per iteration.
+ *
+ * Construct it right before the timing loop so that allocations made by
+ * the layout setup aren't counted.
+ */
+class AllocationCounter
+{
+public:
+    explicit AllocationCounter(benchmark::State &state) : state_(state), start_(allocationCount())
+    {
+    }
+
+    ~AllocationCounter()
+    {
+        state_.counters["allocs"] =
+                benchmark::Counter(static_cast<double>(allocationCount() - start_),
+                                   benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State &state_;
+    size_t start_;
+};
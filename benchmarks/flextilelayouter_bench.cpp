@@ -0,0 +1,166 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "benchutil.h"
+#include "flextilelayouter.h"
+
+namespace {
+using Tile = FlexTileLayouter::Tile;
+
+constexpr QRectF outerPixelRect { 0.0, 0.0, 1920.0, 1080.0 };
+constexpr QSizeF handlePixelSize { 4.0, 4.0 };
+
+std::vector<Tile> createTiles(size_t count)
+{
+    return std::vector<Tile>(count);
+}
+
+/*!
+ * Builds a layout of approximately sqrt(count) columns, each split into rows.
+ *
+ * The number of rows differs by one between columns so that horizontal
+ * borders don't line up across the whole layout.
+ */
+void buildColumns(FlexTileLayouter &layouter, size_t count)
+{
+    const size_t columns = std::max<size_t>(1, std::lround(std::sqrt(count)));
+    if (columns > 1) {
+        layouter.split(0, Qt::Horizontal, createTiles(columns - 1), {});
+    }
+    size_t index = 0;
+    for (size_t c = 0; c < columns; ++c) {
+        const size_t rows = count / columns + (c < count % columns ? 1 : 0);
+        if (rows > 1) {
+            layouter.split(index, Qt::Vertical, createTiles(rows - 1), {});
+        }
+        index += rows;
+    }
+    layouter.resizeTiles(outerPixelRect, handlePixelSize);
+}
+
+void applyTileCounts(benchmark::internal::Benchmark *b)
+{
+    for (int n : { 10, 100, 1000, 10000, 50000 }) {
+        b->Arg(n);
+    }
+}
+
+/// Finds a tile near the center which has a movable top border.
+size_t findMovableTile(const FlexTileLayouter &layouter)
+{
+    size_t index = layouter.count() / 2;
+    while (index + 1 < layouter.count() && layouter.geometry().tileRectAt(index).y0 <= 0.0) {
+        ++index;
+    }
+    return index;
+}
+
+void setTileCountCounter(benchmark::State &state, const FlexTileLayouter &layouter)
+{
+    state.counters["tiles"] = static_cast<double>(layouter.count());
+}
+}
+
+static void BM_FlexTileLayouter_SplitClose(benchmark::State &state)
+{
+    FlexTileLayouter layouter;
+    buildColumns(layouter, static_cast<size_t>(state.range(0)));
+    const size_t index = layouter.count() / 2;
+    {
+        AllocationCounter allocs(state);
+        for (auto _ : state) {
+            layouter.split(index, Qt::Horizontal, createTiles(1), {});
+            layouter.close(index + 1);
+        }
+    }
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_SplitClose)->Apply(applyTileCounts);
+
+static void BM_FlexTileLayouter_StartMoving(benchmark::State &state)
+{
+    FlexTileLayouter layouter;
+    buildColumns(layouter, static_cast<size_t>(state.range(0)));
+    const size_t index = findMovableTile(layouter);
+    {
+        AllocationCounter allocs(state);
+        for (auto _ : state) {
+            layouter.startMoving(index, Qt::Vertical, false, outerPixelRect, handlePixelSize);
+            layouter.resetMovingState();
+        }
+    }
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_StartMoving)->Apply(applyTileCounts);
+
+static void BM_FlexTileLayouter_MoveTo(benchmark::State &state)
+{
+    FlexTileLayouter layouter;
+    buildColumns(layouter, static_cast<size_t>(state.range(0)));
+    const size_t index = findMovableTile(layouter);
+    const auto &rect = layouter.geometry().tileRectAt(index);
+    const qreal y = rect.y0;
+    const qreal delta = (rect.y1 - rect.y0) / 4;
+    layouter.startMoving(index, Qt::Vertical, false, outerPixelRect, handlePixelSize);
+    {
+        AllocationCounter allocs(state);
+        bool up = false;
+        for (auto _ : state) {
+            layouter.moveTo({ 0.0, up ? y - delta : y + delta }, {});
+            up = !up;
+        }
+    }
+    layouter.resetMovingState();
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_MoveTo)->Apply(applyTileCounts);
+
+static void BM_FlexTileLayouter_ResizeTiles(benchmark::State &state)
+{
+    FlexTileLayouter layouter;
+    buildColumns(layouter, static_cast<size_t>(state.range(0)));
+    {
+        AllocationCounter allocs(state);
+        bool wide = false;
+        for (auto _ : state) {
+            const qreal width = outerPixelRect.width() + (wide ? 100.0 : 0.0);
+            layouter.resizeTiles({ 0.0, 0.0, width, outerPixelRect.height() }, handlePixelSize);
+            wide = !wide;
+        }
+    }
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_ResizeTiles)->Apply(applyTileCounts);
+
+static void BM_FlexTileLayouter_LoadTiles(benchmark::State &state)
+{
+    FlexTileLayouter source;
+    buildColumns(source, static_cast<size_t>(state.range(0)));
+    const auto rects = source.geometry().tileRects();
+    FlexTileLayouter layouter;
+    {
+        AllocationCounter allocs(state);
+        for (auto _ : state) {
+            layouter.loadTiles(rects);
+        }
+    }
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_LoadTiles)->Apply(applyTileCounts);
+
+static void BM_FlexTileLayouter_LoadSnapshot(benchmark::State &state)
+{
+    FlexTileLayouter source;
+    buildColumns(source, static_cast<size_t>(state.range(0)));
+    const auto data = source.geometry().saveSnapshot();
+    FlexTileLayouter layouter;
+    {
+        AllocationCounter allocs(state);
+        for (auto _ : state) {
+            layouter.loadSnapshot(data.constData(), static_cast<size_t>(data.size()));
+        }
+    }
+    setTileCountCounter(state, layouter);
+}
+BENCHMARK(BM_FlexTileLayouter_LoadSnapshot)->Apply(applyTileCounts);
@@ -0,0 +1,83 @@
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QtQml>
+#include <benchmark/benchmark.h>
+#include "benchutil.h"
+#include "tiler.h"
+
+namespace {
+/// Exposes the polish step, which runs accumulateTiles() and resizeTiles().
+class BenchTiler : public Tiler
+{
+public:
+    using Tiler::updatePolish;
+};
+
+/*!
+ * Splits every tile in turn, alternating the orientation per round, until
+ * the tiler has the given number of tiles.
+ *
+ * The result is a balanced split tree of depth ~log2(count).
+ */
+void buildBalanced(Tiler &tiler, int count)
+{
+    auto orientation = Qt::Horizontal;
+    while (tiler.count() < count) {
+        for (int i = tiler.count() - 1; i >= 0 && tiler.count() < count; --i) {
+            tiler.split(i, orientation);
+        }
+        orientation = orientation == Qt::Horizontal ? Qt::Vertical : Qt::Horizontal;
+    }
+}
+
+void applyTileCounts(benchmark::internal::Benchmark *b)
+{
+    for (int n : { 10, 100, 1000, 10000, 50000 }) {
+        b->Arg(n);
+    }
+}
+}
+
+static void BM_Tiler_Polish(benchmark::State &state)
+{
+    // Plain items so that the tiles have attached minimum sizes.
+    QQmlEngine engine;
+    QQmlComponent delegate(&engine);
+    delegate.setData("import QtQuick\nItem {}", QUrl());
+    BenchTiler tiler;
+    tiler.setDelegate(&delegate);
+    tiler.setSize({ 1920.0, 1080.0 });
+    buildBalanced(tiler, static_cast<int>(state.range(0)));
+    // Changing the minimum size of a leaf tile dirties the splits up to the root,
+    // which accumulateTiles() has to visit.
+    auto *attached = qobject_cast<TilerAttached *>(
+            qmlAttachedPropertiesObject<Tiler>(tiler.itemAt(tiler.count() / 2)));
+    {
+        AllocationCounter allocs(state);
+        bool wide = false;
+        for (auto _ : state) {
+            tiler.setWidth(wide ? 2020.0 : 1920.0);
+            attached->setMinimumWidth(wide ? 10.0 : 0.0);
+            tiler.updatePolish();
+            wide = !wide;
+        }
+    }
+    state.counters["tiles"] = tiler.count();
+}
+BENCHMARK(BM_Tiler_Polish)->Apply(applyTileCounts);
+
+static void BM_Tiler_SplitClose(benchmark::State &state)
+{
+    Tiler tiler;
+    buildBalanced(tiler, static_cast<int>(state.range(0)));
+    const int index = tiler.count() / 2;
+    {
+        AllocationCounter allocs(state);
+        for (auto _ : state) {
+            tiler.split(index, Qt::Horizontal);
+            tiler.close(index + 1);
+        }
+    }
+    state.counters["tiles"] = tiler.count();
+}
+BENCHMARK(BM_Tiler_SplitClose)->Apply(applyTileCounts);
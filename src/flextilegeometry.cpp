@@ -0,0 +1,1776 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include "flextilegeometry.h"
+
+namespace {
+using Coord = FlexTileGeometry::Coord;
+
+// Minimum viable width/height of tile in fixed-point units. Zero-sized tile is
+// invalid since it would make the vertices map structure corrupted.
+constexpr Coord epsilonTileSize = 1;
+
+/// Returns the nearest key within the epsilon, or the given key if none. |keys| must be sorted.
+Coord snapToKeys(const std::vector<Coord> &keys, Coord key, Coord epsilon)
+{
+    const auto p = std::lower_bound(keys.begin(), keys.end(), key);
+    Coord bestKey = key;
+    Coord bestDistance = epsilon;
+    if (p != keys.begin() && key - *std::prev(p) <= bestDistance) {
+        bestKey = *std::prev(p);
+        bestDistance = key - bestKey;
+    }
+    if (p != keys.end() && *p - key <= bestDistance) {
+        bestKey = *p;
+    }
+    return bestKey;
+}
+
+/*!
+ * Maps normalized position to pixel.
+ *
+ * Avoid sub-pixel alignment of tiles. Be aware that the pixel start may be
+ * negative and std::round() would round it away from zero, which is not what
+ * we want. The offset is rounded half up, which is what mapKeysToPixels() does.
+ */
+qreal mapNormToPixel(qreal pos, qreal pixelStart, qreal pixelLength)
+{
+    return pixelStart + std::floor(pos * pixelLength + 0.5);
+}
+
+/// Maps line key or vertex position to pixel.
+qreal mapKeyToPixel(Coord key, qreal pixelStart, qreal pixelLength)
+{
+    return mapNormToPixel(FlexTileGeometry::toNorm(key), pixelStart, pixelLength);
+}
+
+/*!
+ * Maps keys to pixels in the same way as mapKeyToPixel().
+ *
+ * This is a flat loop over arrays so it can be auto-vectorized. std::floor()
+ * isn't vectorized without -fno-trapping-math, but the offset is non-negative
+ * and truncation to qint32 is equivalent. Scaling by 1/coordOne is exact, so
+ * the results are identical to mapKeyToPixel().
+ */
+void mapKeysToPixels(const Coord *keys, qreal *pixels, size_t count, qreal pixelStart,
+                     qreal pixelLength)
+{
+    Q_ASSERT(pixelLength >= 0 && pixelLength < std::numeric_limits<qint32>::max());
+    const qreal scale = pixelLength / FlexTileGeometry::coordOne;
+    for (size_t i = 0; i < count; ++i) {
+        const qreal offset = static_cast<qreal>(keys[i]) * scale;
+        pixels[i] = pixelStart + static_cast<qint32>(offset + 0.5);
+    }
+}
+
+/// Returns pixel position of the line key, which must exist in the vertices map.
+qreal linePixelAt(const FlexTileGeometry::VerticesMap &verticesMap,
+                  const std::vector<qreal> &linePixels, Coord key)
+{
+    const size_t l = verticesMap.find(key);
+    Q_ASSERT(l < linePixels.size());
+    return linePixels[l];
+}
+
+/// Returns index of the last line not greater than the pixel position, or size() if none.
+size_t findLineAtPixel(const std::vector<qreal> &linePixels, qreal pixelPos)
+{
+    const auto p = std::upper_bound(linePixels.begin(), linePixels.end(), pixelPos);
+    return p != linePixels.begin() ? static_cast<size_t>(p - linePixels.begin()) - 1
+                                   : linePixels.size();
+}
+
+/*!
+ * Returns the last vertex whose pixel position is not greater than the given one.
+ *
+ * Vertex positions are looked up in the lines of the orthogonal vertices map.
+ */
+const FlexTileGeometry::Vertex *findVertexAtPixel(FlexTileGeometry::VerticesMap::ConstLine line,
+                                                  qreal pixelPos,
+                                                  const FlexTileGeometry::VerticesMap &posMap,
+                                                  const std::vector<qreal> &posLinePixels)
+{
+    const auto p = std::partition_point(line.begin(), line.end(), [&](const auto &v) {
+        return linePixelAt(posMap, posLinePixels, v.pos) <= pixelPos;
+    });
+    return p != line.begin() ? std::prev(p) : nullptr;
+}
+
+/*!
+ * Calculates pixel positions of the lines, and moves them apart to fit the minimum
+ * tile sizes. Returns true if any of the lines is moved.
+ *
+ * tileExtentAt(i) should return (key1, minimumPixelLength) of the i-th tile. As in
+ * Tiler, lines are pushed from left/top to right/bottom, and then pulled back from
+ * right/bottom to left/top if the last line overflowed. The first and last lines are
+ * fixed. Lines are kept in order so they can be binary searched by pixel position.
+ * This is O(n log n).
+ *
+ * maxMinimumLength should be the largest minimumPixelLength of the tiles. If no
+ * adjacent lines are closer than that, no tile extents need to be looked up.
+ */
+template<typename F>
+bool constrainLinePixels(const FlexTileGeometry::VerticesMap &verticesMap, F tileExtentAt,
+                         qreal maxMinimumLength, qreal pixelStart, qreal pixelLength,
+                         std::vector<qreal> &linePixels)
+{
+    const auto &keys = verticesMap.keys();
+    Q_ASSERT(keys.size() >= 2 && keys.front() == 0
+             && keys.back() == FlexTileGeometry::coordOne);
+    linePixels.resize(keys.size());
+    mapKeysToPixels(keys.data(), linePixels.data(), keys.size(), pixelStart, pixelLength);
+    if (std::adjacent_find(linePixels.begin(), linePixels.end(),
+                           [maxMinimumLength](qreal p0, qreal p1) {
+                               return p1 < p0 + maxMinimumLength;
+                           })
+        == linePixels.end())
+        return false;
+
+    const size_t last = keys.size() - 1;
+    const qreal endPixel = linePixels[last];
+
+    bool adjusted = false;
+    for (size_t l = 0; l < last; ++l) {
+        if (l > 0 && linePixels[l] < linePixels[l - 1]) {
+            linePixels[l] = linePixels[l - 1];
+        }
+        for (const auto &v : verticesMap.line(l)) {
+            if (v.tileIndex < 0 || !v.primary)
+                continue;
+            const auto [key1, minimumLength] = tileExtentAt(static_cast<size_t>(v.tileIndex));
+            const size_t l1 = verticesMap.find(key1);
+            Q_ASSERT(l1 < keys.size());
+            if (linePixels[l1] < linePixels[l] + minimumLength) {
+                linePixels[l1] = linePixels[l] + minimumLength;
+                adjusted = true;
+            }
+        }
+    }
+    if (!adjusted)
+        return false;
+
+    linePixels[last] = endPixel;
+    for (size_t l = last - 1; l > 0; --l) {
+        qreal pos = std::min(linePixels[l], linePixels[l + 1]);
+        for (const auto &v : verticesMap.line(l)) {
+            if (v.tileIndex < 0 || !v.primary)
+                continue;
+            const auto [key1, minimumLength] = tileExtentAt(static_cast<size_t>(v.tileIndex));
+            pos = std::min(linePixels[verticesMap.find(key1)] - minimumLength, pos);
+        }
+        // The first tiles are squeezed if the total minimum size doesn't fit.
+        linePixels[l] = std::max(pos, linePixels.front());
+    }
+    return true;
+}
+
+std::tuple<Coord, Coord, Coord> xySpan(const FlexTileGeometry::KeyRect &rect)
+{
+    return { rect.x0, rect.x1, rect.y0 };
+}
+
+std::tuple<Coord, Coord, Coord> yxSpan(const FlexTileGeometry::KeyRect &rect)
+{
+    return { rect.y0, rect.y1, rect.x0 };
+}
+
+/// Calculates relation of the tiles between the lines[index - 1] and lines[index].
+void calculateAdjacentRelation(FlexTileGeometry::VerticesMap &verticesMap, size_t index,
+                               std::vector<bool> &tilesCollapsible)
+{
+    Q_ASSERT(index > 0);
+    const auto line0 = verticesMap.line(index - 1);
+    const auto line1 = verticesMap.line(index);
+    for (auto &v : line1) {
+        v.handleEnd = v.pos;
+    }
+    if (line0.empty() || line1.empty())
+        return; // split by infinite line
+    auto v0s = line0.begin();
+    auto v1s = line1.begin();
+    auto v0p = std::next(v0s);
+    auto v1p = std::next(v1s);
+    int d0 = 1, d1 = 1;
+    while (v0p != line0.end() && v1p != line1.end()) {
+        // Handle can be isolated if two vertices of the adjacent lines meet.
+        if (v0p->pos == v1p->pos) { // should exactly match here
+            Q_ASSERT(v0s->tileIndex >= 0 && v1s->tileIndex >= 0);
+            v1s->handleEnd = v1p->pos;
+            // A single cell can be collapsed if the adjacent lines meet.
+            const bool border = v0s->tileIndex != v1s->tileIndex;
+            if (d0 == 1 && border) {
+                tilesCollapsible.at(static_cast<size_t>(v0s->tileIndex)) = true;
+            }
+            if (d1 == 1 && border) {
+                tilesCollapsible.at(static_cast<size_t>(v1s->tileIndex)) = true;
+            }
+            v0s = v0p;
+            v1s = v1p;
+            ++v0p;
+            ++v1p;
+            d0 = d1 = 1;
+        } else if (v0p->pos < v1p->pos) {
+            ++v0p;
+            ++d0;
+        } else {
+            ++v1p;
+            ++d1;
+        }
+    }
+    Q_ASSERT(v0p == line0.end() && v1p == line1.end());
+}
+}
+
+namespace {
+/*!
+ * Snapshot file format (native byte order, all fields 8-byte aligned)
+ *
+ * SnapshotHeader
+ * SnapshotRect[tileCount]
+ * quint8[tileCount] tilesCollapsible, padded to 8 bytes
+ * VerticesMap xy, yx:
+ *     quint64 lineCount, vertexCount
+ *     qint32[lineCount] keys, padded to 8 bytes
+ *     quint64[lineCount + 1] offsets (none if lineCount == 0)
+ *     SnapshotVertex[vertexCount]
+ */
+constexpr char snapshotMagic[8] = { 'F', 'L', 'X', 'T', 'S', 'N', 'A', 'P' };
+constexpr quint32 snapshotVersion = 2; // fixed-point coordinates since 2
+constexpr quint32 snapshotByteOrderMark = 0x01020304;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrderMark;
+    quint64 tileCount;
+};
+
+struct SnapshotRect
+{
+    qint32 x0, y0;
+    qint32 x1, y1;
+};
+
+struct SnapshotVertex
+{
+    qint32 pos;
+    qint32 handleEnd;
+    qint32 tileIndex;
+    quint32 primary;
+};
+
+static_assert(sizeof(SnapshotHeader) == 24 && sizeof(SnapshotRect) == 16
+              && sizeof(SnapshotVertex) == 16);
+
+constexpr size_t snapshotPadding(size_t size)
+{
+    return (8 - size % 8) % 8;
+}
+
+template<typename T>
+void writeRaw(QByteArray &data, const T &value)
+{
+    data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/// Copies count values from the data. The data may be unaligned, e.g. mmap-ed file.
+template<typename T>
+bool readRaw(const char *&data, const char *end, T *values, size_t count = 1)
+{
+    if (static_cast<size_t>(end - data) / sizeof(T) < count)
+        return false;
+    std::memcpy(values, data, count * sizeof(T));
+    data += count * sizeof(T);
+    return true;
+}
+
+/*!
+ * Checks if the tiles exactly cover the unit rect without overlaps.
+ *
+ * The xy map must have been checked against the tile rects by readSnapshot(). Then
+ * each tile spans the strips between the lines of [x0, x1), and the strip between
+ * adjacent lines is covered if the tiles stacked in the line leave no gap.
+ */
+bool coversUnitRect(const FlexTileGeometry::VerticesMap &xyVerticesMap,
+                    const std::vector<FlexTileGeometry::KeyRect> &rects)
+{
+    for (size_t l = 0; l + 1 < xyVerticesMap.size(); ++l) {
+        Coord y = 0;
+        for (const auto &v : xyVerticesMap.line(l)) {
+            if (v.pos != y)
+                return false;
+            if (v.tileIndex < 0)
+                break; // terminator at 1.0
+            y = rects[static_cast<size_t>(v.tileIndex)].y1;
+        }
+    }
+    return true;
+}
+
+/*!
+ * Checks if the handles and the collapsible tiles are calculated from the adjacent
+ * lines as buildVerticesMaps() does.
+ *
+ * The lines must have been checked by readSnapshot() and coversUnitRect().
+ */
+bool hasAdjacentRelation(FlexTileGeometry::VerticesMap &xyVerticesMap,
+                         FlexTileGeometry::VerticesMap &yxVerticesMap,
+                         const std::vector<bool> &tilesCollapsible)
+{
+    std::vector<bool> builtTilesCollapsible(tilesCollapsible.size(), false);
+    std::vector<Coord> handleEnds;
+    for (auto *verticesMap : { &xyVerticesMap, &yxVerticesMap }) {
+        // First line should have no handle.
+        const auto line0 = verticesMap->line(0);
+        if (std::any_of(line0.begin(), line0.end(),
+                        [](const auto &v) { return v.handleEnd != v.pos; }))
+            return false;
+        for (size_t l = 1; l < verticesMap->size(); ++l) {
+            const auto line = verticesMap->line(l);
+            handleEnds.clear();
+            std::transform(line.begin(), line.end(), std::back_inserter(handleEnds),
+                           [](const auto &v) { return v.handleEnd; });
+            calculateAdjacentRelation(*verticesMap, l, builtTilesCollapsible);
+            if (!std::equal(line.begin(), line.end(), handleEnds.begin(),
+                            [](const auto &v, Coord e) { return v.handleEnd == e; }))
+                return false;
+        }
+    }
+    return builtTilesCollapsible == tilesCollapsible;
+}
+}
+
+void FlexTileGeometry::VerticesMap::clear()
+{
+    // Keep the allocated storage since the map will soon be rebuilt.
+    keys_.clear();
+    offsets_.clear();
+    vertices_.clear();
+}
+
+/*!
+ * Builds lines of vertices from the tiles.
+ *
+ * tileSpanAt(i) should return (key0, key1, pos) of the i-th tile. The tile
+ * is mapped to vertices at pos on the lines of [key0, key1).
+ */
+template<typename F>
+void FlexTileGeometry::VerticesMap::build(size_t tileCount, F tileSpanAt)
+{
+    Q_ASSERT(empty());
+
+    // Collect all possible lines. Suppose we have infinite borders at right/bottom,
+    // there should be no vertices on the terminal line.
+    keys_.reserve(tileCount + 1);
+    for (size_t i = 0; i < tileCount; ++i) {
+        keys_.push_back(std::get<0>(tileSpanAt(i)));
+    }
+    keys_.push_back(coordOne);
+    std::sort(keys_.begin(), keys_.end());
+    keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+
+    // Count vertices per line. All lines but the terminal one have a terminator.
+    auto &spans = spans_;
+    spans.clear();
+    spans.reserve(tileCount);
+    offsets_.assign(keys_.size() + 1, 0);
+    for (size_t i = 0; i < tileCount; ++i) {
+        const auto [key0, key1, pos] = tileSpanAt(i);
+        const Span span = { pos, i, lowerBound(key0), lowerBound(key1) };
+        for (size_t l = span.line0; l < span.line1; ++l) {
+            offsets_[l + 1] += 1;
+        }
+        spans.push_back(span);
+    }
+    for (size_t l = 0; l + 1 < keys_.size(); ++l) {
+        offsets_[l + 1] += 1;
+    }
+    std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+    // Fill vertices in order of pos so that each line is sorted without sorting
+    // the vertices.
+    std::sort(spans.begin(), spans.end(),
+              [](const Span &a, const Span &b) { return a.pos < b.pos; });
+    auto &cursors = cursors_;
+    cursors.assign(offsets_.begin(), std::prev(offsets_.end()));
+    vertices_.resize(offsets_.back());
+    for (const auto &span : spans) {
+        for (size_t l = span.line0; l < span.line1; ++l) {
+            vertices_[cursors[l]++] = { span.pos, static_cast<int>(span.tileIndex),
+                                        l == span.line0, span.pos };
+        }
+    }
+    for (size_t l = 0; l + 1 < keys_.size(); ++l) {
+        Q_ASSERT(cursors[l] + 1 == offsets_[l + 1]);
+        vertices_[cursors[l]++] = { coordOne, -1, false, coordOne };
+    }
+}
+
+/*!
+ * Renumbers tile indices after tiles are inserted (delta > 0) or removed
+ * (delta < 0) at the specified position.
+ *
+ * Vertices of the removed tiles are left in place and must be cleaned up by
+ * updateLines().
+ */
+void FlexTileGeometry::VerticesMap::shiftTileIndices(size_t from, int delta)
+{
+    if (delta == 0)
+        return;
+    const int removedEnd = static_cast<int>(from) - std::min(delta, 0);
+    for (auto &v : vertices_) {
+        if (v.tileIndex < static_cast<int>(from))
+            continue;
+        v.tileIndex = v.tileIndex < removedEnd ? removedTileIndex : v.tileIndex + delta;
+    }
+}
+
+/*!
+ * Rebuilds lines affected by the changed tiles.
+ *
+ * changedTiles must be sorted, and keyRanges must cover both the old and new
+ * spans of the changed tiles. keyRanges is sorted in place. Indices of the lines
+ * of which adjacent relation needs to be recalculated are appended to dirtyLines.
+ */
+template<typename F>
+void FlexTileGeometry::VerticesMap::updateLines(const std::vector<int> &changedTiles,
+                                                std::vector<std::tuple<Coord, Coord>> &keyRanges,
+                                                F tileSpanAt, std::vector<size_t> &dirtyLines)
+{
+    Q_ASSERT(!empty());
+    Q_ASSERT(std::is_sorted(changedTiles.begin(), changedTiles.end()));
+    const auto isChanged = [&changedTiles](int i) {
+        return std::binary_search(changedTiles.begin(), changedTiles.end(), i);
+    };
+
+    // Allocate lines newly started by the changed tiles. The contents will be
+    // filled later.
+    for (const int i : changedTiles) {
+        const Coord key0 = std::get<0>(tileSpanAt(static_cast<size_t>(i)));
+        const size_t l = lowerBound(key0);
+        if (l == keys_.size() || keys_[l] != key0) {
+            insertLine(l, key0);
+        }
+    }
+
+    // Tiles on the line k are the tiles started at k plus the ones spanning from
+    // the previous line. Lines outside of the changed ranges are kept intact.
+    std::sort(keyRanges.begin(), keyRanges.end());
+    auto &dirtyKeys = dirtyKeys_;
+    auto &primaryVertices = primaryVertices_;
+    auto &spanningVertices = spanningVertices_;
+    auto &vertices = lineVertices_;
+    dirtyKeys.clear();
+    size_t l = 0;
+    for (const auto &[key0, key1] : keyRanges) {
+        for (l = std::max(l, lowerBound(key0)); l < keys_.size() && keys_[l] < key1;) {
+            const Coord key = keys_[l];
+            primaryVertices.clear();
+            for (const auto &v : line(l)) {
+                if (!v.primary || v.tileIndex < 0 || isChanged(v.tileIndex))
+                    continue;
+                primaryVertices.push_back({ v.pos, v.tileIndex, true, v.pos });
+            }
+            const auto mid = primaryVertices.size();
+            for (const int i : changedTiles) {
+                const auto [k0, k1, pos] = tileSpanAt(static_cast<size_t>(i));
+                if (k0 != key)
+                    continue;
+                primaryVertices.push_back({ pos, i, true, pos });
+            }
+            const auto byPos = [](const Vertex &a, const Vertex &b) { return a.pos < b.pos; };
+            std::sort(primaryVertices.begin() + static_cast<ptrdiff_t>(mid), primaryVertices.end(),
+                      byPos);
+            // std::inplace_merge() would allocate a temporary buffer.
+            const auto midPos = primaryVertices.begin() + static_cast<ptrdiff_t>(mid);
+            vertices.clear();
+            std::merge(primaryVertices.begin(), midPos, midPos, primaryVertices.end(),
+                       std::back_inserter(vertices), byPos);
+            primaryVertices.swap(vertices);
+
+            dirtyKeys.push_back(key);
+            if (primaryVertices.empty()) {
+                eraseLine(l);
+                continue;
+            }
+
+            spanningVertices.clear();
+            if (l > 0) {
+                for (const auto &v : line(l - 1)) {
+                    if (v.tileIndex < 0)
+                        continue;
+                    if (std::get<1>(tileSpanAt(static_cast<size_t>(v.tileIndex))) <= key)
+                        continue;
+                    spanningVertices.push_back({ v.pos, v.tileIndex, false, v.pos });
+                }
+            }
+
+            vertices.clear();
+            std::merge(primaryVertices.begin(), primaryVertices.end(), spanningVertices.begin(),
+                       spanningVertices.end(), std::back_inserter(vertices), byPos);
+            vertices.push_back({ coordOne, -1, false, coordOne });
+            replaceLine(l, vertices);
+            ++l;
+        }
+    }
+
+    // Adjacent relation of the line pairs around the rebuilt lines may change.
+    for (const Coord key : dirtyKeys) {
+        const size_t i = lowerBound(key);
+        if (i > 0 && i < keys_.size()) {
+            dirtyLines.push_back(i);
+        }
+        if (i < keys_.size() && keys_[i] == key && i + 1 < keys_.size()) {
+            dirtyLines.push_back(i + 1);
+        }
+    }
+}
+
+void FlexTileGeometry::VerticesMap::writeSnapshot(QByteArray &data) const
+{
+    writeRaw(data, static_cast<quint64>(keys_.size()));
+    writeRaw(data, static_cast<quint64>(vertices_.size()));
+    for (const Coord k : keys_) {
+        writeRaw(data, static_cast<qint32>(k));
+    }
+    for (size_t i = 0; i < snapshotPadding(keys_.size() * sizeof(qint32)); ++i) {
+        writeRaw(data, quint8(0));
+    }
+    for (const size_t o : offsets_) {
+        writeRaw(data, static_cast<quint64>(o));
+    }
+    for (const auto &v : vertices_) {
+        const quint32 primary = v.primary ? 1 : 0;
+        writeRaw(data, SnapshotVertex { v.pos, v.handleEnd, v.tileIndex, primary });
+    }
+}
+
+/*!
+ * Reads lines written by writeSnapshot().
+ *
+ * The lines are copied in bulk, and checked to be consistent with the tiles, but
+ * not rebuilt. tileSpanAt(i) should return (key0, key1, pos) of the i-th tile as
+ * in build(). The tile rects must be within the unit rect, but may overlap.
+ * Returns false if the data is malformed.
+ */
+template<typename F>
+bool FlexTileGeometry::VerticesMap::readSnapshot(const char *&data, const char *end,
+                                                 size_t tileCount, F tileSpanAt)
+{
+    quint64 lineCount, vertexCount;
+    if (!readRaw(data, end, &lineCount) || !readRaw(data, end, &vertexCount))
+        return false;
+    // Reject bogus counts before allocating memory. There should be at least the
+    // first and terminal lines.
+    const auto remaining = static_cast<quint64>(end - data);
+    if (lineCount < 2 || lineCount > remaining / sizeof(qint32)
+        || vertexCount > remaining / sizeof(SnapshotVertex))
+        return false;
+
+    keys_.resize(static_cast<size_t>(lineCount));
+    offsets_.resize(keys_.size() + 1);
+    vertices_.resize(static_cast<size_t>(vertexCount));
+    static_assert(sizeof(Coord) == sizeof(qint32));
+    if (!readRaw(data, end, keys_.data(), keys_.size()))
+        return false;
+    data += std::min(snapshotPadding(keys_.size() * sizeof(qint32)),
+                     static_cast<size_t>(end - data));
+    for (auto &o : offsets_) {
+        quint64 v;
+        if (!readRaw(data, end, &v) || v > vertexCount)
+            return false;
+        o = static_cast<size_t>(v);
+    }
+    for (auto &v : vertices_) {
+        SnapshotVertex sv;
+        if (!readRaw(data, end, &sv))
+            return false;
+        v = { sv.pos, sv.tileIndex, sv.primary != 0, sv.handleEnd };
+    }
+
+    // Check the structure built by build() in one pass: lines are sorted and start
+    // at tiles, each tile is mapped to the lines of [key0, key1) at its pos, and
+    // each line but the terminal one ends with a terminator.
+    if (keys_.front() != 0 || keys_.back() != coordOne)
+        return false;
+    if (offsets_.front() != 0 || offsets_.back() != vertices_.size())
+        return false;
+    auto &vertexCounts = cursors_; // per tile
+    vertexCounts.assign(tileCount, 0);
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (i > 0 && !(keys_[i - 1] < keys_[i]))
+            return false;
+        if (offsets_[i] > offsets_[i + 1])
+            return false;
+        const auto l = line(i);
+        const bool terminal = i + 1 == keys_.size();
+        if (terminal != l.empty())
+            return false;
+        bool hasPrimary = false;
+        for (auto p = l.begin(); p != l.end(); ++p) {
+            if (p != l.begin() && !(std::prev(p)->pos < p->pos))
+                return false;
+            if (p->tileIndex == -1) {
+                if (std::next(p) != l.end() || p->pos != coordOne || p->handleEnd != coordOne)
+                    return false;
+                continue;
+            }
+            if (p->tileIndex < 0 || p->tileIndex >= static_cast<int>(tileCount)
+                || std::next(p) == l.end())
+                return false;
+            const auto [key0, key1, pos] = tileSpanAt(static_cast<size_t>(p->tileIndex));
+            if (!(key0 <= l.key() && l.key() < key1) || p->pos != pos
+                || p->primary != (key0 == l.key()))
+                return false;
+            // Handle should span to one of the subsequent vertices if visible.
+            if (p->handleEnd < p->pos
+                || (p->handleEnd > p->pos && l.find(p->handleEnd) == l.end()))
+                return false;
+            hasPrimary = hasPrimary || p->primary;
+            vertexCounts[static_cast<size_t>(p->tileIndex)] += 1;
+        }
+        if (!terminal && !hasPrimary)
+            return false;
+    }
+    for (size_t i = 0; i < tileCount; ++i) {
+        const auto [key0, key1, pos] = tileSpanAt(i);
+        const size_t l0 = find(key0);
+        const size_t l1 = find(key1);
+        if (l0 == keys_.size() || l1 == keys_.size() || vertexCounts[i] != l1 - l0)
+            return false;
+    }
+    return true;
+}
+
+bool FlexTileGeometry::VerticesMap::operator==(const VerticesMap &other) const
+{
+    const auto vertexEquals = [](const Vertex &a, const Vertex &b) {
+        return a.pos == b.pos && a.tileIndex == b.tileIndex && a.primary == b.primary
+                && a.handleEnd == b.handleEnd;
+    };
+    return keys_ == other.keys_ && offsets_ == other.offsets_
+            && std::equal(vertices_.begin(), vertices_.end(), other.vertices_.begin(),
+                          other.vertices_.end(), vertexEquals);
+}
+
+void FlexTileGeometry::VerticesMap::insertLine(size_t index, Coord key)
+{
+    keys_.insert(keys_.begin() + static_cast<ptrdiff_t>(index), key);
+    offsets_.insert(offsets_.begin() + static_cast<ptrdiff_t>(index), offsets_.at(index));
+}
+
+void FlexTileGeometry::VerticesMap::eraseLine(size_t index)
+{
+    const size_t first = offsets_.at(index);
+    const size_t last = offsets_.at(index + 1);
+    vertices_.erase(vertices_.begin() + static_cast<ptrdiff_t>(first),
+                    vertices_.begin() + static_cast<ptrdiff_t>(last));
+    keys_.erase(keys_.begin() + static_cast<ptrdiff_t>(index));
+    offsets_.erase(offsets_.begin() + static_cast<ptrdiff_t>(index) + 1);
+    for (size_t i = index + 1; i < offsets_.size(); ++i) {
+        offsets_[i] -= last - first;
+    }
+}
+
+void FlexTileGeometry::VerticesMap::replaceLine(size_t index, const std::vector<Vertex> &vertices)
+{
+    const size_t first = offsets_.at(index);
+    const size_t last = offsets_.at(index + 1);
+    const size_t n = std::min(last - first, vertices.size());
+    std::copy_n(vertices.begin(), n, vertices_.begin() + static_cast<ptrdiff_t>(first));
+    if (vertices.size() == last - first)
+        return;
+    if (vertices.size() < last - first) {
+        vertices_.erase(vertices_.begin() + static_cast<ptrdiff_t>(first + n),
+                        vertices_.begin() + static_cast<ptrdiff_t>(last));
+    } else {
+        vertices_.insert(vertices_.begin() + static_cast<ptrdiff_t>(last),
+                         vertices.begin() + static_cast<ptrdiff_t>(n), vertices.end());
+    }
+    for (size_t i = index + 1; i < offsets_.size(); ++i) {
+        offsets_[i] = offsets_[i] - last + first + vertices.size();
+    }
+}
+
+FlexTileGeometry::FlexTileGeometry()
+{
+    tileRects_.push_back({ 0, 0, coordOne, coordOne });
+    minimumSizes_.emplace_back(0.0, 0.0);
+    buildVerticesMaps(tileRects_, xyVerticesMap_, yxVerticesMap_, tilesCollapsible_);
+}
+
+/// Rounds the normalized coordinate to the nearest fixed-point unit within [0, 1].
+auto FlexTileGeometry::fromNorm(qreal v) -> Coord
+{
+    if (!(v > 0.0))
+        return 0; // including NaN
+    if (v >= 1.0)
+        return coordOne;
+    return static_cast<Coord>(std::round(v * coordOne));
+}
+
+auto FlexTileGeometry::toNormRect(const KeyRect &rect) -> NormRect
+{
+    return { toNorm(rect.x0), toNorm(rect.y0), toNorm(rect.x1), toNorm(rect.y1) };
+}
+
+auto FlexTileGeometry::fromNormRect(const NormRect &rect) -> KeyRect
+{
+    return { fromNorm(rect.x0), fromNorm(rect.y0), fromNorm(rect.x1), fromNorm(rect.y1) };
+}
+
+auto FlexTileGeometry::tileRects() const -> std::vector<NormRect>
+{
+    std::vector<NormRect> rects;
+    rects.reserve(tileRects_.size());
+    std::transform(tileRects_.begin(), tileRects_.end(), std::back_inserter(rects), toNormRect);
+    return rects;
+}
+
+/// Sets the minimum pixel size of the tile, which will be respected by startMoving().
+void FlexTileGeometry::setMinimumSize(size_t index, const QSizeF &pixelSize)
+{
+    minimumSizes_.at(index) = pixelSize;
+    ++revision_;
+}
+
+/*!
+ * Checks if the rects exactly cover the unit rect without overlaps.
+ *
+ * The coverage is tested by the total area and the corner points. Every corner
+ * point must be shared by an even number of rects except for the four outer
+ * corners. The rects are rounded to the fixed-point units in the same way as
+ * loadTiles().
+ */
+bool FlexTileGeometry::isValidLayout(const std::vector<NormRect> &rects)
+{
+    const auto inRange = [](qreal v) { return 0.0 <= v && v <= 1.0; };
+    const bool allInRange = std::all_of(rects.begin(), rects.end(), [inRange](const auto &r) {
+        return inRange(r.x0) && inRange(r.y0) && inRange(r.x1) && inRange(r.y1);
+    });
+    if (!allInRange)
+        return false;
+
+    std::vector<KeyRect> keyRects;
+    keyRects.reserve(rects.size());
+    std::transform(rects.begin(), rects.end(), std::back_inserter(keyRects), fromNormRect);
+    return isValidKeyLayout(keyRects);
+}
+
+bool FlexTileGeometry::isValidKeyLayout(const std::vector<KeyRect> &rects)
+{
+    if (rects.empty())
+        return false;
+
+    // The area can be summed up exactly. No overflow occurs as long as each rect
+    // is within the unit rect and the total is bounded.
+    constexpr qint64 unitArea = qint64(coordOne) * coordOne;
+    qint64 area = 0;
+    std::vector<std::tuple<Coord, Coord>> corners;
+    corners.reserve(4 * rects.size());
+    for (const auto &r : rects) {
+        if (!(0 <= r.x0 && r.x0 < r.x1 && r.x1 <= coordOne))
+            return false;
+        if (!(0 <= r.y0 && r.y0 < r.y1 && r.y1 <= coordOne))
+            return false;
+        area += qint64(r.x1 - r.x0) * (r.y1 - r.y0);
+        if (area > unitArea)
+            return false;
+        corners.emplace_back(r.x0, r.y0);
+        corners.emplace_back(r.x1, r.y0);
+        corners.emplace_back(r.x0, r.y1);
+        corners.emplace_back(r.x1, r.y1);
+    }
+    if (area != unitArea)
+        return false;
+
+    std::sort(corners.begin(), corners.end());
+    size_t outerCornerCount = 0;
+    for (auto p = corners.begin(); p != corners.end();) {
+        const auto q = std::find_if(p, corners.end(), [p](const auto &c) { return c != *p; });
+        const auto [x, y] = *p;
+        const bool outer = (x == 0 || x == coordOne) && (y == 0 || y == coordOne);
+        const auto n = q - p;
+        if (outer) {
+            if (n != 1)
+                return false;
+            ++outerCornerCount;
+        } else if (n % 2 != 0) {
+            return false;
+        }
+        p = q;
+    }
+    return outerCornerCount == 4;
+}
+
+/*!
+ * Replaces all tiles at once, and builds the vertices maps from scratch.
+ *
+ * The tile rects must be validated by isValidLayout(). Minimum sizes are reset.
+ */
+void FlexTileGeometry::loadTiles(const std::vector<NormRect> &rects)
+{
+    Q_ASSERT(!rects.empty());
+    resetMovingState();
+    tileRects_.clear();
+    std::transform(rects.begin(), rects.end(), std::back_inserter(tileRects_), fromNormRect);
+    minimumSizes_.assign(tileRects_.size(), QSizeF(0.0, 0.0));
+    ++indexRevision_;
+    xyVerticesMap_.clear();
+    yxVerticesMap_.clear();
+    tilesCollapsible_.clear();
+    buildVerticesMaps(tileRects_, xyVerticesMap_, yxVerticesMap_, tilesCollapsible_);
+}
+
+/*!
+ * Replaces all tiles with the ones of the other geometry.
+ *
+ * Only the tile rects and minimum sizes are copied. The vertices maps are rebuilt
+ * on demand, e.g. by calculatePixelRects() in a worker thread, reusing the storage
+ * of this geometry. The revisions are copied to match the result with the other.
+ */
+void FlexTileGeometry::assignTiles(const FlexTileGeometry &other)
+{
+    resetMovingState();
+    tileRects_ = other.tileRects_;
+    minimumSizes_ = other.minimumSizes_;
+    xyVerticesMap_.clear();
+    yxVerticesMap_.clear();
+    tilesCollapsible_.clear();
+    linePixels_.xs.clear();
+    linePixels_.ys.clear();
+    revision_ = other.revision_;
+    indexRevision_ = other.indexRevision_;
+}
+
+/// Serializes the tile rects and the vertices maps in the snapshot format.
+QByteArray FlexTileGeometry::saveSnapshot() const
+{
+    const VerticesMap *xyVerticesMap = &xyVerticesMap_;
+    const VerticesMap *yxVerticesMap = &yxVerticesMap_;
+    const std::vector<bool> *tilesCollapsible = &tilesCollapsible_;
+    VerticesMap builtXyVerticesMap, builtYxVerticesMap;
+    std::vector<bool> builtTilesCollapsible;
+    if (xyVerticesMap_.empty()) {
+        buildVerticesMaps(tileRects_, builtXyVerticesMap, builtYxVerticesMap,
+                          builtTilesCollapsible);
+        xyVerticesMap = &builtXyVerticesMap;
+        yxVerticesMap = &builtYxVerticesMap;
+        tilesCollapsible = &builtTilesCollapsible;
+    }
+
+    QByteArray data;
+    SnapshotHeader header {};
+    std::copy(std::begin(snapshotMagic), std::end(snapshotMagic), header.magic);
+    header.version = snapshotVersion;
+    header.byteOrderMark = snapshotByteOrderMark;
+    header.tileCount = tileRects_.size();
+    writeRaw(data, header);
+    for (const auto &r : tileRects_) {
+        writeRaw(data, SnapshotRect { r.x0, r.y0, r.x1, r.y1 });
+    }
+    for (const bool c : *tilesCollapsible) {
+        writeRaw(data, static_cast<quint8>(c));
+    }
+    for (size_t i = 0; i < snapshotPadding(tileRects_.size()); ++i) {
+        writeRaw(data, quint8(0));
+    }
+    xyVerticesMap->writeSnapshot(data);
+    yxVerticesMap->writeSnapshot(data);
+    return data;
+}
+
+/*!
+ * Replaces all tiles with the ones stored by saveSnapshot().
+ *
+ * The data can be a memory-mapped file. Unlike loadTiles(), the vertices maps
+ * are copied from the data without being rebuilt. Returns false without
+ * changing the tiles if the data is malformed. Minimum sizes are reset.
+ */
+bool FlexTileGeometry::loadSnapshot(const char *data, size_t size)
+{
+    const char *p = data;
+    const char *end = data + size;
+    SnapshotHeader header;
+    if (!readRaw(p, end, &header))
+        return false;
+    if (!std::equal(std::begin(snapshotMagic), std::end(snapshotMagic), header.magic)
+        || header.version != snapshotVersion || header.byteOrderMark != snapshotByteOrderMark)
+        return false;
+    const auto tileCount = header.tileCount;
+    if (tileCount == 0 || tileCount > static_cast<quint64>(end - p) / sizeof(SnapshotRect))
+        return false;
+
+    std::vector<KeyRect> rects;
+    rects.reserve(tileCount);
+    for (quint64 i = 0; i < tileCount; ++i) {
+        SnapshotRect r;
+        readRaw(p, end, &r);
+        if (!(0 <= r.x0 && r.x0 < r.x1 && r.x1 <= coordOne))
+            return false;
+        if (!(0 <= r.y0 && r.y0 < r.y1 && r.y1 <= coordOne))
+            return false;
+        rects.push_back({ r.x0, r.y0, r.x1, r.y1 });
+    }
+    std::vector<bool> tilesCollapsible(tileCount);
+    for (quint64 i = 0; i < tileCount; ++i) {
+        quint8 c;
+        if (!readRaw(p, end, &c))
+            return false;
+        tilesCollapsible[i] = c != 0;
+    }
+    p += std::min(snapshotPadding(tileCount), static_cast<size_t>(end - p));
+    VerticesMap xyVerticesMap, yxVerticesMap;
+    const auto xySpanAt = [&rects](size_t i) { return xySpan(rects[i]); };
+    const auto yxSpanAt = [&rects](size_t i) { return yxSpan(rects[i]); };
+    if (!xyVerticesMap.readSnapshot(p, end, rects.size(), xySpanAt)
+        || !yxVerticesMap.readSnapshot(p, end, rects.size(), yxSpanAt) || p != end)
+        return false;
+    // The layout is validated by the sorted lines, not by sorting the tile corners.
+    if (!coversUnitRect(xyVerticesMap, rects)
+        || !hasAdjacentRelation(xyVerticesMap, yxVerticesMap, tilesCollapsible))
+        return false;
+
+    resetMovingState();
+    tileRects_ = std::move(rects);
+    minimumSizes_.assign(tileRects_.size(), QSizeF(0.0, 0.0));
+    ++indexRevision_;
+    xyVerticesMap_ = std::move(xyVerticesMap);
+    yxVerticesMap_ = std::move(yxVerticesMap);
+    tilesCollapsible_ = std::move(tilesCollapsible);
+    return true;
+}
+
+/// Splits the specified tile into newCount + 1 tiles. New tiles are inserted after the index.
+void FlexTileGeometry::split(size_t index, Qt::Orientation orientation, size_t newCount,
+                             const QSizeF &snapSize)
+{
+    resetMovingState();
+    ensureVerticesMapBuilt();
+    ++indexRevision_;
+
+    // Insert new tile and adjust indices. Unchanged (x, y) values must be preserved.
+    // New borders may snap to existing vertices, but shouldn't move excessively compared
+    // to the tile width/height. Otherwise the tiles would be stacked.
+    const auto origRect = tileRects_.at(index);
+    tileRects_.insert(tileRects_.begin() + static_cast<ptrdiff_t>(index) + 1, newCount, {});
+    minimumSizes_.insert(minimumSizes_.begin() + static_cast<ptrdiff_t>(index) + 1, newCount,
+                         QSizeF(0.0, 0.0));
+    // Round to the nearest unit as fromNorm() does so the same fraction maps to the
+    // same line. Calculated in 64 bits to not overflow the product.
+    const auto divide = [newCount](Coord start, Coord end, size_t i) {
+        const auto d = static_cast<qint64>(newCount + 1);
+        return start + static_cast<Coord>((qint64(end - start) * qint64(i) * 2 + d) / (2 * d));
+    };
+    if (orientation == Qt::Horizontal) {
+        const Coord w = divide(origRect.x0, origRect.x1, 1) - origRect.x0;
+        const Coord e = std::min(fromNorm(snapSize.width()), w / 10);
+        Q_ASSERT(w >= epsilonTileSize);
+        std::vector<Coord> xs;
+        for (size_t i = 0; i < newCount; ++i) {
+            const Coord x = divide(origRect.x0, origRect.x1, i + 1);
+            xs.push_back(snapToKeys(xyVerticesMap_.keys(), x, e));
+        }
+        xs.push_back(origRect.x1);
+
+        tileRects_.at(index).x1 = xs.at(0);
+        for (size_t i = 0; i < newCount; ++i) {
+            const Coord x0 = xs.at(i);
+            const Coord x1 = xs.at(i + 1);
+            tileRects_.at(index + 1 + i) = { x0, origRect.y0, x1, origRect.y1 };
+        }
+    } else {
+        const Coord h = divide(origRect.y0, origRect.y1, 1) - origRect.y0;
+        const Coord e = std::min(fromNorm(snapSize.height()), h / 10);
+        Q_ASSERT(h >= epsilonTileSize);
+        std::vector<Coord> ys;
+        for (size_t i = 0; i < newCount; ++i) {
+            const Coord y = divide(origRect.y0, origRect.y1, i + 1);
+            ys.push_back(snapToKeys(yxVerticesMap_.keys(), y, e));
+        }
+        ys.push_back(origRect.y1);
+
+        tileRects_.at(index).y1 = ys.at(0);
+        for (size_t i = 0; i < newCount; ++i) {
+            const Coord y0 = ys.at(i);
+            const Coord y1 = ys.at(i + 1);
+            tileRects_.at(index + 1 + i) = { origRect.x0, y0, origRect.x1, y1 };
+        }
+    }
+
+    std::vector<ChangedTile> changedTiles;
+    changedTiles.push_back({ static_cast<int>(index), origRect });
+    for (size_t i = 0; i < newCount; ++i) {
+        changedTiles.push_back({ static_cast<int>(index + 1 + i), std::nullopt });
+    }
+    updateVerticesMap(index + 1, static_cast<int>(newCount), changedTiles);
+}
+
+/*!
+ * Closes the specified tile and collapses the adjacent tiles to fill the area.
+ *
+ * Returns index of one of the tiles filled the closed area, or -1 if the tile
+ * couldn't be collapsed to any of the adjacent tiles.
+ */
+int FlexTileGeometry::close(size_t index)
+{
+    resetMovingState();
+    ensureVerticesMapBuilt();
+
+    const auto collectLine = [](VerticesMap::ConstLine line, Coord pos0,
+                                Coord pos1) -> std::vector<int> {
+        std::vector<int> indices;
+        auto vp = line.find(pos0);
+        for (; vp != line.end() && vp->pos < pos1; ++vp) {
+            Q_ASSERT(vp->tileIndex >= 0);
+            indices.push_back(vp->tileIndex);
+        }
+        if (vp == line.end() || vp->pos > pos1)
+            return {}; // unaligned tiles
+        return indices;
+    };
+
+    const auto collectPrev = [collectLine](const VerticesMap &verticesMap, Coord key0, Coord pos0,
+                                           Coord pos1) -> std::vector<int> {
+        const size_t l = verticesMap.find(key0);
+        if (l == 0 || l == verticesMap.size())
+            return {};
+        return collectLine(verticesMap.line(l - 1), pos0, pos1);
+    };
+
+    const auto collectNext = [collectLine](const VerticesMap &verticesMap, Coord key1, Coord pos0,
+                                           Coord pos1) -> std::vector<int> {
+        const size_t l = verticesMap.find(key1);
+        if (l == verticesMap.size())
+            return {};
+        return collectLine(verticesMap.line(l), pos0, pos1);
+    };
+
+    const auto avgIndexDistance = [index](const std::vector<int> &toIndices) {
+        if (toIndices.empty())
+            return std::numeric_limits<qreal>::max();
+        const int d = std::accumulate(toIndices.begin(), toIndices.end(), 0, [index](int n, int i) {
+            return n + std::abs(i - static_cast<int>(index));
+        });
+        return static_cast<qreal>(d) / static_cast<qreal>(toIndices.size());
+    };
+
+    const auto origRect = tileRects_.at(index);
+    const std::array<std::vector<int>, 4> collectedIndices {
+        collectPrev(xyVerticesMap_, origRect.x0, origRect.y0, origRect.y1), // left
+        collectNext(xyVerticesMap_, origRect.x1, origRect.y0, origRect.y1), // right
+        collectPrev(yxVerticesMap_, origRect.y0, origRect.x0, origRect.x1), // top
+        collectNext(yxVerticesMap_, origRect.y1, origRect.x0, origRect.x1), // bottom
+    };
+    // If there are multiple candidates, pick the closest in the tiles vector so
+    // the tiles previously split will likely be merged.
+    auto bestIndices = collectedIndices.end();
+    qreal bestIndexDistance = std::numeric_limits<qreal>::max();
+    for (auto p = collectedIndices.begin(); p != collectedIndices.end(); ++p) {
+        const qreal d = avgIndexDistance(*p);
+        if (d >= bestIndexDistance)
+            continue;
+        bestIndices = p;
+        bestIndexDistance = d;
+    }
+    if (bestIndices == collectedIndices.end())
+        return -1;
+    Q_ASSERT(!bestIndices->empty());
+    std::vector<ChangedTile> changedTiles;
+    changedTiles.push_back({ -1, origRect });
+    for (const int i : *bestIndices) {
+        const int shiftedIndex = i - static_cast<int>(i >= static_cast<int>(index));
+        changedTiles.push_back({ shiftedIndex, tileRects_.at(static_cast<size_t>(i)) });
+    }
+    switch (bestIndices - collectedIndices.begin()) {
+    case 0:
+        // Found left matches, which will be expanded to right.
+        for (const int i : *bestIndices) {
+            auto &rect = tileRects_.at(static_cast<size_t>(i));
+            rect.x1 = origRect.x1;
+        }
+        break;
+    case 1:
+        // Found right matches, which will be expanded to left.
+        for (const int i : *bestIndices) {
+            auto &rect = tileRects_.at(static_cast<size_t>(i));
+            rect.x0 = origRect.x0;
+        }
+        break;
+    case 2:
+        // Found top matches, which will be expanded to bottom.
+        for (const int i : *bestIndices) {
+            auto &rect = tileRects_.at(static_cast<size_t>(i));
+            rect.y1 = origRect.y1;
+        }
+        break;
+    case 3:
+        // Found bottom matches, which will be expanded to top.
+        for (const int i : *bestIndices) {
+            auto &rect = tileRects_.at(static_cast<size_t>(i));
+            rect.y0 = origRect.y0;
+        }
+        break;
+    }
+
+    ++indexRevision_;
+    tileRects_.erase(tileRects_.begin() + static_cast<ptrdiff_t>(index));
+    minimumSizes_.erase(minimumSizes_.begin() + static_cast<ptrdiff_t>(index));
+
+    updateVerticesMap(index, -1, changedTiles);
+    return bestIndices->front() - static_cast<int>(bestIndices->front() >= static_cast<int>(index));
+}
+
+bool FlexTileGeometry::isMoving() const
+{
+    return !movingTiles_.left.empty() || !movingTiles_.right.empty() || !movingTiles_.top.empty()
+            || !movingTiles_.bottom.empty();
+}
+
+void FlexTileGeometry::startMoving(size_t index, Qt::Orientations orientations, bool lineThrough,
+                                   const QRectF &outerPixelRect, const QSizeF &handlePixelSize)
+{
+    ensureVerticesMapBuilt();
+    ++revision_;
+    movingTiles_ = lineThrough ? collectAdjacentTilesThrough(index, orientations)
+                               : collectAdjacentTiles(index, orientations);
+    movableKeyRect_ =
+            calculateMovableKeyRect(index, movingTiles_, outerPixelRect, handlePixelSize);
+    // Only the line positions are needed to snap. assign() reuses the capacity of the
+    // previous drag session.
+    preMoveXKeys_.assign(xyVerticesMap_.keys().begin(), xyVerticesMap_.keys().end());
+    preMoveYKeys_.assign(yxVerticesMap_.keys().begin(), yxVerticesMap_.keys().end());
+}
+
+void FlexTileGeometry::moveTo(const QPointF &normPos, const QSizeF &snapSize)
+{
+    Q_ASSERT(isMoving());
+    const auto &movable = movableKeyRect_;
+    if (movable.x1 <= movable.x0 || movable.y1 <= movable.y0)
+        return;
+    const Coord x = snapToKeys(preMoveXKeys_, fromNorm(normPos.x()), fromNorm(snapSize.width()));
+    const Coord y = snapToKeys(preMoveYKeys_, fromNorm(normPos.y()), fromNorm(snapSize.height()));
+    moveAdjacentTiles(movingTiles_, std::clamp(x, movable.x0, movable.x1),
+                      std::clamp(y, movable.y0, movable.y1));
+}
+
+void FlexTileGeometry::resetMovingState()
+{
+    ++revision_;
+    movingTiles_ = {};
+    movableKeyRect_ = {};
+    preMoveXKeys_.clear();
+    preMoveYKeys_.clear();
+}
+
+auto FlexTileGeometry::collectAdjacentTiles(size_t index, Qt::Orientations orientations) const
+        -> AdjacentIndices
+{
+    const auto collect = [](const VerticesMap &verticesMap, Coord key1,
+                            Coord pos0) -> std::tuple<std::vector<int>, std::vector<int>> {
+        // Determine the right/bottom line from the handle item, and collect tiles
+        // within the handle span.
+        const size_t l1 = verticesMap.find(key1);
+        if (l1 == 0 || l1 == verticesMap.size())
+            return {};
+        const auto line1 = verticesMap.line(l1);
+        const auto v1s = line1.find(pos0);
+        if (v1s == line1.end())
+            return {};
+        const Coord pos1 = v1s->handleEnd;
+        std::vector<int> tiles1;
+        for (auto p = v1s; p != line1.end() && p->pos < pos1; ++p) {
+            Q_ASSERT(p->tileIndex >= 0);
+            tiles1.push_back(p->tileIndex);
+        }
+
+        // Collect tiles on the adjacent left/top line within the same range.
+        const auto line0 = verticesMap.line(l1 - 1);
+        std::vector<int> tiles0;
+        for (auto p = line0.find(pos0); p != line0.end() && p->pos < pos1; ++p) {
+            Q_ASSERT(p->tileIndex >= 0);
+            tiles0.push_back(p->tileIndex);
+        }
+
+        return { tiles0, tiles1 };
+    };
+
+    AdjacentIndices indices;
+    const auto &rect = tileRects_.at(index);
+    if (orientations & Qt::Horizontal) {
+        std::tie(indices.left, indices.right) = collect(xyVerticesMap_, rect.x0, rect.y0);
+    }
+    if (orientations & Qt::Vertical) {
+        std::tie(indices.top, indices.bottom) = collect(yxVerticesMap_, rect.y0, rect.x0);
+    }
+
+    return indices;
+}
+
+auto FlexTileGeometry::collectAdjacentTilesThrough(size_t index,
+                                                   Qt::Orientations orientations) const
+        -> AdjacentIndices
+{
+    const auto collect = [](const VerticesMap &verticesMap, Coord key1,
+                            Coord pos) -> std::tuple<std::vector<int>, std::vector<int>> {
+        // Walk through the line to determine contiguous range including the source item.
+        const size_t l1 = verticesMap.find(key1);
+        if (l1 == 0 || l1 == verticesMap.size())
+            return {};
+        const auto line1 = verticesMap.line(l1);
+        Coord pos0 = coordOne, pos1 = 0;
+        std::vector<int> tiles1;
+        for (auto p = line1.begin(); p != line1.end(); ++p) {
+            if (!p->primary && p->pos > pos) { // reached to right/bottom edge
+                pos1 = p->pos;
+                break;
+            } else if (!p->primary) { // not contiguous to the source item
+                pos0 = coordOne;
+                tiles1.clear();
+                continue;
+            }
+            Q_ASSERT(p->tileIndex >= 0);
+            if (tiles1.empty()) {
+                pos0 = p->pos;
+            }
+            tiles1.push_back(p->tileIndex);
+        }
+
+        // Collect tiles on the adjacent left/top line within the same range.
+        const auto line0 = verticesMap.line(l1 - 1);
+        std::vector<int> tiles0;
+        for (auto p = line0.find(pos0); p != line0.end() && p->pos < pos1; ++p) {
+            Q_ASSERT(p->tileIndex >= 0);
+            tiles0.push_back(p->tileIndex);
+        }
+
+        return { tiles0, tiles1 };
+    };
+
+    AdjacentIndices indices;
+    const auto &rect = tileRects_.at(index);
+    if (orientations & Qt::Horizontal) {
+        std::tie(indices.left, indices.right) = collect(xyVerticesMap_, rect.x0, rect.y0);
+    }
+    if (orientations & Qt::Vertical) {
+        std::tie(indices.top, indices.bottom) = collect(yxVerticesMap_, rect.y0, rect.x0);
+    }
+
+    return indices;
+}
+
+auto FlexTileGeometry::calculateMovableKeyRect(size_t index,
+                                               const AdjacentIndices &adjacentIndices,
+                                               const QRectF &outerPixelRect,
+                                               const QSizeF &handlePixelSize) const -> KeyRect
+{
+    // Calculated in 64 bits since the minimum sizes may exceed the unit length.
+    const auto minimumTileWidth = [this, &outerPixelRect](size_t i) -> qint64 {
+        const qreal w = minimumSizes_.at(i).width();
+        return std::max(fromNorm(w / outerPixelRect.width()), epsilonTileSize);
+    };
+    const auto minimumTileHeight = [this, &outerPixelRect](size_t i) -> qint64 {
+        const qreal h = minimumSizes_.at(i).height();
+        return std::max(fromNorm(h / outerPixelRect.height()), epsilonTileSize);
+    };
+
+    qint64 left = 0;
+    qint64 right = coordOne;
+    qint64 top = 0;
+    qint64 bottom = coordOne;
+
+    for (const auto i : adjacentIndices.left) {
+        const qint64 x = tileRects_.at(static_cast<size_t>(i)).x0;
+        left = std::max(x + minimumTileWidth(static_cast<size_t>(i)), left);
+    }
+
+    for (const auto i : adjacentIndices.right) {
+        const qint64 x = tileRects_.at(static_cast<size_t>(i)).x1;
+        right = std::min(x, right);
+    }
+
+    for (const auto i : adjacentIndices.top) {
+        const qint64 y = tileRects_.at(static_cast<size_t>(i)).y0;
+        top = std::max(y + minimumTileHeight(static_cast<size_t>(i)), top);
+    }
+
+    for (const auto i : adjacentIndices.bottom) {
+        const qint64 y = tileRects_.at(static_cast<size_t>(i)).y1;
+        bottom = std::min(y, bottom);
+    }
+
+    const qint64 marginX = fromNorm(handlePixelSize.width() / outerPixelRect.width());
+    const qint64 marginY = fromNorm(handlePixelSize.height() / outerPixelRect.height());
+    // Clamping keeps the empty range empty.
+    const auto clamp = [](qint64 v) {
+        return static_cast<Coord>(std::clamp<qint64>(v, 0, coordOne));
+    };
+    return {
+        clamp(left + marginX),
+        clamp(top + marginY),
+        clamp(right - marginX - minimumTileWidth(index)),
+        clamp(bottom - marginY - minimumTileHeight(index)),
+    };
+}
+
+void FlexTileGeometry::moveAdjacentTiles(const AdjacentIndices &indices, Coord x, Coord y)
+{
+    ++revision_;
+    auto &changedTiles = changedTiles_;
+    changedTiles.clear();
+    for (const auto *v : { &indices.left, &indices.right, &indices.top, &indices.bottom }) {
+        for (const auto i : *v) {
+            changedTiles.push_back({ i, tileRects_.at(static_cast<size_t>(i)) });
+        }
+    }
+
+    for (const auto i : indices.left) {
+        auto &rect = tileRects_.at(static_cast<size_t>(i));
+        rect.x1 = x;
+    }
+
+    for (const auto i : indices.right) {
+        auto &rect = tileRects_.at(static_cast<size_t>(i));
+        rect.x0 = x;
+    }
+
+    for (const auto i : indices.top) {
+        auto &rect = tileRects_.at(static_cast<size_t>(i));
+        rect.y1 = y;
+    }
+
+    for (const auto i : indices.bottom) {
+        auto &rect = tileRects_.at(static_cast<size_t>(i));
+        rect.y0 = y;
+    }
+
+    const bool moved = std::any_of(changedTiles.begin(), changedTiles.end(), [this](auto &c) {
+        const auto &r = tileRects_.at(static_cast<size_t>(c.index));
+        return r.x0 != c.oldRect->x0 || r.y0 != c.oldRect->y0 || r.x1 != c.oldRect->x1
+                || r.y1 != c.oldRect->y1;
+    });
+    if (!moved)
+        return;
+    updateVerticesMap(0, 0, changedTiles);
+}
+
+void FlexTileGeometry::ensureVerticesMapBuilt()
+{
+    if (!xyVerticesMap_.empty())
+        return;
+    buildVerticesMaps(tileRects_, xyVerticesMap_, yxVerticesMap_, tilesCollapsible_);
+}
+
+void FlexTileGeometry::buildVerticesMaps(const std::vector<KeyRect> &rects,
+                                         VerticesMap &xyVerticesMap, VerticesMap &yxVerticesMap,
+                                         std::vector<bool> &tilesCollapsible)
+{
+    // Map tiles to vertices per axis
+    //
+    //       x0  xm  x1          xyVertices          yxVertices
+    //        '   '   '          x0  xm  x1
+    //            |               '   '   '
+    // y0- ---o---+---o---        A   +   B          y0- A-------B---
+    //        |       |           |   :   |
+    // ym- ---+   A   |           |   :   |          ym- +~~~~~~~+~~~
+    //        |       | B         |   :   |
+    // y1-    o-------+           C   +   |          y1- C-------+~~~
+    //        |   C   |           |   :   |
+    //
+    // xyVertices {              // describes vertical lines made by horizontal splits
+    //     x0: {y0, A}, {y1, C}  // A (x0, y0..y1), C (x0, y1..end)
+    //     xm: {y0, -}, {y1, -}
+    //     x1: {y0, B}           // B (x1, y0..end)
+    // }
+    // yxVertices {              // describes horizontal lines made by vertical splits
+    //     y0: {x0, A}, {x1, B}  // A (x0..x1, y0), B (x1..end, y0)
+    //     ym: {x0, -}, {x1, -}
+    //     y1: {x0, C}, {x1, -}  // C (x0..x1, y1)
+    // }
+    Q_ASSERT(xyVerticesMap.empty() && yxVerticesMap.empty());
+    xyVerticesMap.build(rects.size(), [&rects](size_t i) {
+        const auto &r = rects.at(i);
+        Q_ASSERT(0 <= r.x0 && r.x0 < coordOne && 0 <= r.y0 && r.y0 < coordOne);
+        Q_ASSERT(r.x0 <= r.x1 && r.y0 <= r.y1);
+        return xySpan(r);
+    });
+    yxVerticesMap.build(rects.size(), [&rects](size_t i) { return yxSpan(rects.at(i)); });
+
+    // Calculate relation of adjacent tiles (e.g. handle span) per axis.
+    // First line should have no handle, so skipped updating handlePixelSize.
+    Q_ASSERT(tilesCollapsible.empty());
+    tilesCollapsible.resize(rects.size(), false);
+    for (size_t l = 1; l < xyVerticesMap.size(); ++l) {
+        calculateAdjacentRelation(xyVerticesMap, l, tilesCollapsible);
+    }
+    for (size_t l = 1; l < yxVerticesMap.size(); ++l) {
+        calculateAdjacentRelation(yxVerticesMap, l, tilesCollapsible);
+    }
+}
+
+/*!
+ * Updates the vertices maps for the changed tiles.
+ *
+ * Tiles at [shiftFrom, shiftFrom - shiftDelta) are removed if shiftDelta < 0, and
+ * the subsequent tiles are shifted by shiftDelta. changedTiles should contain the
+ * removed, inserted, and resized tiles, with the old rect if any.
+ */
+void FlexTileGeometry::updateVerticesMap(size_t shiftFrom, int shiftDelta,
+                                         const std::vector<ChangedTile> &changedTiles)
+{
+    if (xyVerticesMap_.empty())
+        return; // will be built from scratch
+
+    auto &changedIndices = changedIndices_;
+    auto &xyKeyRanges = xyKeyRanges_;
+    auto &yxKeyRanges = yxKeyRanges_;
+    changedIndices.clear();
+    xyKeyRanges.clear();
+    yxKeyRanges.clear();
+    for (const auto &c : changedTiles) {
+        if (c.oldRect) {
+            xyKeyRanges.push_back({ c.oldRect->x0, c.oldRect->x1 });
+            yxKeyRanges.push_back({ c.oldRect->y0, c.oldRect->y1 });
+        }
+        if (c.index < 0)
+            continue;
+        const auto &r = tileRects_.at(static_cast<size_t>(c.index));
+        xyKeyRanges.push_back({ r.x0, r.x1 });
+        yxKeyRanges.push_back({ r.y0, r.y1 });
+        changedIndices.push_back(c.index);
+    }
+    std::sort(changedIndices.begin(), changedIndices.end());
+    changedIndices.erase(std::unique(changedIndices.begin(), changedIndices.end()),
+                         changedIndices.end());
+
+    auto &xyDirtyLines = xyDirtyLines_;
+    auto &yxDirtyLines = yxDirtyLines_;
+    xyDirtyLines.clear();
+    yxDirtyLines.clear();
+    xyVerticesMap_.shiftTileIndices(shiftFrom, shiftDelta);
+    xyVerticesMap_.updateLines(
+            changedIndices, xyKeyRanges, [this](size_t i) { return xySpan(tileRects_.at(i)); },
+            xyDirtyLines);
+    yxVerticesMap_.shiftTileIndices(shiftFrom, shiftDelta);
+    yxVerticesMap_.updateLines(
+            changedIndices, yxKeyRanges, [this](size_t i) { return yxSpan(tileRects_.at(i)); },
+            yxDirtyLines);
+
+    const auto shiftFromPos = tilesCollapsible_.begin() + static_cast<ptrdiff_t>(shiftFrom);
+    if (shiftDelta > 0) {
+        tilesCollapsible_.insert(shiftFromPos, static_cast<size_t>(shiftDelta), false);
+    } else if (shiftDelta < 0) {
+        tilesCollapsible_.erase(shiftFromPos, shiftFromPos - shiftDelta);
+    }
+    Q_ASSERT(tilesCollapsible_.size() == tileRects_.size());
+
+    // The collapsible state is a union of the relation of the line pairs. Tiles
+    // on the dirty lines have to be reevaluated against all line pairs around them.
+    const auto collectDirtyTiles = [](const VerticesMap &verticesMap,
+                                      const std::vector<size_t> &dirtyLines,
+                                      std::vector<int> &dirtyTiles) {
+        for (const size_t l : dirtyLines) {
+            for (const size_t k : { l - 1, l }) {
+                for (const auto &v : verticesMap.line(k)) {
+                    if (v.tileIndex < 0)
+                        continue;
+                    dirtyTiles.push_back(v.tileIndex);
+                }
+            }
+        }
+    };
+    auto &dirtyTiles = dirtyTiles_;
+    dirtyTiles.clear();
+    collectDirtyTiles(xyVerticesMap_, xyDirtyLines, dirtyTiles);
+    collectDirtyTiles(yxVerticesMap_, yxDirtyLines, dirtyTiles);
+    std::sort(dirtyTiles.begin(), dirtyTiles.end());
+    dirtyTiles.erase(std::unique(dirtyTiles.begin(), dirtyTiles.end()), dirtyTiles.end());
+
+    const auto collectTileLines = [](const VerticesMap &verticesMap, Coord key0, Coord key1,
+                                     std::vector<size_t> &dirtyLines) {
+        const size_t l0 = verticesMap.find(key0);
+        const size_t l1 = verticesMap.find(key1);
+        Q_ASSERT(l0 < verticesMap.size() && l1 < verticesMap.size());
+        if (l0 > 0) {
+            dirtyLines.push_back(l0);
+        }
+        dirtyLines.push_back(l1);
+    };
+    for (const int i : dirtyTiles) {
+        const auto &r = tileRects_.at(static_cast<size_t>(i));
+        tilesCollapsible_.at(static_cast<size_t>(i)) = false;
+        collectTileLines(xyVerticesMap_, r.x0, r.x1, xyDirtyLines);
+        collectTileLines(yxVerticesMap_, r.y0, r.y1, yxDirtyLines);
+    }
+
+    const auto recalculateDirtyLines = [this](VerticesMap &verticesMap,
+                                              std::vector<size_t> &dirtyLines) {
+        std::sort(dirtyLines.begin(), dirtyLines.end());
+        dirtyLines.erase(std::unique(dirtyLines.begin(), dirtyLines.end()), dirtyLines.end());
+        for (const size_t l : dirtyLines) {
+            calculateAdjacentRelation(verticesMap, l, tilesCollapsible_);
+        }
+    };
+    recalculateDirtyLines(xyVerticesMap_, xyDirtyLines);
+    recalculateDirtyLines(yxVerticesMap_, yxDirtyLines);
+
+    Q_ASSERT_X(verifyVerticesMap(), __FUNCTION__, "inconsistent with the rebuilt map");
+}
+
+/*!
+ * Checks if the current vertices maps are identical to the ones built from
+ * scratch.
+ *
+ * This is slow and is intended for debugging.
+ */
+bool FlexTileGeometry::verifyVerticesMap() const
+{
+    if (xyVerticesMap_.empty())
+        return true;
+    verifiedXyVerticesMap_.clear();
+    verifiedYxVerticesMap_.clear();
+    verifiedTilesCollapsible_.clear();
+    buildVerticesMaps(tileRects_, verifiedXyVerticesMap_, verifiedYxVerticesMap_,
+                      verifiedTilesCollapsible_);
+    return verifiedXyVerticesMap_ == xyVerticesMap_ && verifiedYxVerticesMap_ == yxVerticesMap_
+            && verifiedTilesCollapsible_ == tilesCollapsible_;
+}
+
+/*!
+ * Calculates the pixel geometry of the tile items and handles to fit the outer rect.
+ *
+ * pixelRects is resized to count(). Its storage is reused across calls.
+ *
+ * Tile edges are copied to separate x0/x1/y0/y1 arrays and mapped to pixels in
+ * one linear sweep, so each edge is rounded once. If the tiles don't fit the
+ * minimum sizes, the edges are moved in pixel space without changing the
+ * normalized layout. See calculateLinePixels().
+ */
+void FlexTileGeometry::calculatePixelRects(const QRectF &outerPixelRect,
+                                           const QSizeF &handlePixelSize,
+                                           std::vector<PixelRects> &pixelRects)
+{
+    ensureVerticesMapBuilt();
+    const bool adjusted = calculateLinePixels(outerPixelRect, handlePixelSize, linePixels_);
+    const auto mapToPixelX = [this, adjusted, &outerPixelRect](Coord x) {
+        return adjusted ? linePixelAt(xyVerticesMap_, linePixels_.xs, x)
+                        : mapKeyToPixel(x, outerPixelRect.left(), outerPixelRect.width());
+    };
+    const auto mapToPixelY = [this, adjusted, &outerPixelRect](Coord y) {
+        return adjusted ? linePixelAt(yxVerticesMap_, linePixels_.ys, y)
+                        : mapKeyToPixel(y, outerPixelRect.top(), outerPixelRect.height());
+    };
+
+    // Layout: [x0...][x1...][y0...][y1...]
+    const size_t n = tileRects_.size();
+    edgeKeys_.resize(4 * n);
+    edgePixels_.resize(4 * n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto &r = tileRects_[i];
+        edgeKeys_[i] = r.x0;
+        edgeKeys_[n + i] = r.x1;
+        edgeKeys_[2 * n + i] = r.y0;
+        edgeKeys_[3 * n + i] = r.y1;
+    }
+    if (adjusted) {
+        for (size_t i = 0; i < 2 * n; ++i) {
+            edgePixels_[i] = mapToPixelX(edgeKeys_[i]);
+        }
+        for (size_t i = 2 * n; i < 4 * n; ++i) {
+            edgePixels_[i] = mapToPixelY(edgeKeys_[i]);
+        }
+    } else {
+        mapKeysToPixels(edgeKeys_.data(), edgePixels_.data(), 2 * n, outerPixelRect.left(),
+                        outerPixelRect.width());
+        mapKeysToPixels(edgeKeys_.data() + 2 * n, edgePixels_.data() + 2 * n, 2 * n,
+                        outerPixelRect.top(), outerPixelRect.height());
+    }
+    const qreal *pixelX0 = edgePixels_.data();
+    const qreal *pixelX1 = pixelX0 + n;
+    const qreal *pixelY0 = pixelX1 + n;
+    const qreal *pixelY1 = pixelY0 + n;
+
+    const qreal mw = handlePixelSize.width();
+    const qreal mh = handlePixelSize.height();
+    pixelRects.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        pixelRects[i].item.setRect(pixelX0[i] + mw, pixelY0[i] + mh, pixelX1[i] - pixelX0[i] - mw,
+                                   pixelY1[i] - pixelY0[i] - mh);
+    }
+
+    for (size_t l = 0; l < xyVerticesMap_.size(); ++l) {
+        const auto line = std::as_const(xyVerticesMap_).line(l);
+        for (const auto &v : line) {
+            // No need to update handles for all of the spanned cells.
+            if (v.tileIndex < 0 || !v.primary)
+                continue;
+            const auto i = static_cast<size_t>(v.tileIndex);
+            auto &rects = pixelRects[i];
+            if (v.handleEnd <= v.pos) {
+                rects.horizontalHandle.reset();
+                continue;
+            }
+            const qreal y1 = mapToPixelY(v.handleEnd);
+            rects.horizontalHandle = QRectF(pixelX0[i], pixelY0[i] + mh, mw, y1 - pixelY0[i] - mh);
+        }
+    }
+
+    for (size_t l = 0; l < yxVerticesMap_.size(); ++l) {
+        const auto line = std::as_const(yxVerticesMap_).line(l);
+        for (const auto &v : line) {
+            if (v.tileIndex < 0 || !v.primary)
+                continue;
+            const auto i = static_cast<size_t>(v.tileIndex);
+            auto &rects = pixelRects[i];
+            if (v.handleEnd <= v.pos) {
+                rects.verticalHandle.reset();
+                continue;
+            }
+            const qreal x1 = mapToPixelX(v.handleEnd);
+            rects.verticalHandle = QRectF(pixelX0[i] + mw, pixelY0[i], x1 - pixelX0[i] - mw, mh);
+        }
+    }
+}
+
+/*!
+ * Calculates pixel positions of the lines of the vertices maps, and returns true
+ * if any of them is moved to fit the minimum tile sizes.
+ *
+ * Each tile item should be at least as large as its minimum size. Since the tile
+ * includes its left/top handle, the handle size is added to the minimum size.
+ */
+bool FlexTileGeometry::calculateLinePixels(const QRectF &outerPixelRect,
+                                           const QSizeF &handlePixelSize,
+                                           LinePixels &linePixels) const
+{
+    Q_ASSERT(!xyVerticesMap_.empty());
+    QSizeF maxMinimumSize(0.0, 0.0);
+    for (const auto &size : minimumSizes_) {
+        maxMinimumSize = maxMinimumSize.expandedTo(size);
+    }
+    const bool xAdjusted = constrainLinePixels(
+            xyVerticesMap_,
+            [this, &handlePixelSize](size_t i) {
+                return std::tuple(tileRects_[i].x1,
+                                  handlePixelSize.width() + minimumSizes_[i].width());
+            },
+            handlePixelSize.width() + maxMinimumSize.width(), outerPixelRect.left(),
+            outerPixelRect.width(), linePixels.xs);
+    const bool yAdjusted = constrainLinePixels(
+            yxVerticesMap_,
+            [this, &handlePixelSize](size_t i) {
+                return std::tuple(tileRects_[i].y1,
+                                  handlePixelSize.height() + minimumSizes_[i].height());
+            },
+            handlePixelSize.height() + maxMinimumSize.height(), outerPixelRect.top(),
+            outerPixelRect.height(), linePixels.ys);
+    linePixels.revision = revision_;
+    linePixels.outerPixelRect = outerPixelRect;
+    linePixels.handlePixelSize = handlePixelSize;
+    return xAdjusted || yAdjusted;
+}
+
+/*!
+ * Returns the line pixel positions calculated by the last calculatePixelRects() if
+ * up to date, or calculates them in the buffer.
+ */
+auto FlexTileGeometry::linePixelsFor(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                                     LinePixels &buffer) const -> const LinePixels &
+{
+    const auto &cached = linePixels_;
+    if (cached.revision == revision_ && cached.xs.size() == xyVerticesMap_.size()
+        && cached.ys.size() == yxVerticesMap_.size() && cached.outerPixelRect == outerPixelRect
+        && cached.handlePixelSize == handlePixelSize)
+        return cached;
+    calculateLinePixels(outerPixelRect, handlePixelSize, buffer);
+    return buffer;
+}
+
+/*!
+ * Returns index of the tile at the given pixel position, or -1 if none.
+ *
+ * The tile area includes its left and top handles. outerPixelRect and handlePixelSize
+ * should be the ones passed to calculatePixelRects(). This is O(log^2 n) if the
+ * pixel rects are up to date, or O(n log n) otherwise.
+ */
+int FlexTileGeometry::tileAt(const QPointF &pixelPos, const QRectF &outerPixelRect,
+                             const QSizeF &handlePixelSize) const
+{
+    Q_ASSERT(!xyVerticesMap_.empty());
+    LinePixels buffer;
+    const auto &linePixels = linePixelsFor(outerPixelRect, handlePixelSize, buffer);
+    const size_t l = findLineAtPixel(linePixels.xs, pixelPos.x());
+    if (l + 1 >= xyVerticesMap_.size())
+        return -1; // out of bounds or terminal line
+    const auto *v =
+            findVertexAtPixel(xyVerticesMap_.line(l), pixelPos.y(), yxVerticesMap_, linePixels.ys);
+    return v ? v->tileIndex : -1;
+}
+
+/*!
+ * Returns index and orientation of the visible handle at the given pixel position,
+ * or -1 if none.
+ *
+ * Handle rects are the same as the ones calculated by calculatePixelRects().
+ */
+std::tuple<int, Qt::Orientations> FlexTileGeometry::handleAt(const QPointF &pixelPos,
+                                                             const QRectF &outerPixelRect,
+                                                             const QSizeF &handlePixelSize) const
+{
+    Q_ASSERT(!xyVerticesMap_.empty());
+    LinePixels buffer;
+    const auto &linePixels = linePixelsFor(outerPixelRect, handlePixelSize, buffer);
+    const auto find = [](const VerticesMap &verticesMap, const std::vector<qreal> &keyLinePixels,
+                         qreal keyPixelPos, qreal thickness, const VerticesMap &posMap,
+                         const std::vector<qreal> &posLinePixels, qreal pixelPos,
+                         qreal margin) -> int {
+        size_t l = findLineAtPixel(keyLinePixels, keyPixelPos);
+        if (l + 1 >= verticesMap.size())
+            return -1; // out of bounds or terminal line
+        // Handles of close lines may overlap. First line has no handle.
+        for (; l > 0; --l) {
+            const auto line = verticesMap.line(l);
+            if (keyPixelPos >= keyLinePixels[l] + thickness)
+                break;
+            const auto *v = findVertexAtPixel(line, pixelPos, posMap, posLinePixels);
+            if (!v)
+                continue;
+            // Walk back to the first vertex of the handle span, which is usually adjacent.
+            while (v != line.begin() && v->handleEnd <= v->pos) {
+                --v;
+            }
+            if (v->primary && v->handleEnd > v->pos
+                && pixelPos >= linePixelAt(posMap, posLinePixels, v->pos) + margin
+                && pixelPos < linePixelAt(posMap, posLinePixels, v->handleEnd))
+                return v->tileIndex;
+        }
+        return -1;
+    };
+
+    const int h = find(xyVerticesMap_, linePixels.xs, pixelPos.x(), handlePixelSize.width(),
+                       yxVerticesMap_, linePixels.ys, pixelPos.y(), handlePixelSize.height());
+    if (h >= 0)
+        return { h, Qt::Horizontal };
+    const int v = find(yxVerticesMap_, linePixels.ys, pixelPos.y(), handlePixelSize.height(),
+                       xyVerticesMap_, linePixels.xs, pixelPos.x(), handlePixelSize.width());
+    if (v >= 0)
+        return { v, Qt::Vertical };
+    return { -1, {} };
+}
+
+/*!
+ * Maps normalized position to pixel in the same way as calculatePixelRects().
+ *
+ * The minimum tile sizes aren't taken into account.
+ */
+QPointF FlexTileGeometry::mapToPixel(const QPointF &normPos, const QRectF &outerPixelRect)
+{
+    return { mapNormToPixel(normPos.x(), outerPixelRect.left(), outerPixelRect.width()),
+             mapNormToPixel(normPos.y(), outerPixelRect.top(), outerPixelRect.height()) };
+}
@@ -0,0 +1,284 @@
+#pragma once
+#include <QByteArray>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <algorithm>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+/*!
+ * Geometry of the FlexTiler tiles in normalized coordinates.
+ *
+ * This doesn't depend on Qt Quick, and can be used without a QML engine. Tiles
+ * are identified by index. Minimum tile sizes are given in pixels.
+ *
+ * Internally, the normalized coordinates are stored in fixed point so the tile
+ * borders can be compared exactly. Coordinates passed in as qreal are rounded
+ * to the nearest fixed-point unit.
+ */
+class FlexTileGeometry
+{
+public:
+    FlexTileGeometry();
+
+    /// Normalized coordinate in units of 1/2^30. 0 is left/top, coordOne is right/bottom.
+    using Coord = qint32;
+    static constexpr int coordFractionBits = 30;
+    static constexpr Coord coordOne = Coord(1) << coordFractionBits;
+    static constexpr qreal toNorm(Coord c) { return static_cast<qreal>(c) / coordOne; }
+    static Coord fromNorm(qreal v);
+
+    /// Tile rect in normalized coordinates.
+    struct NormRect
+    {
+        qreal x0, y0;
+        qreal x1, y1;
+    };
+
+    struct KeyRect
+    {
+        Coord x0, y0;
+        Coord x1, y1;
+    };
+
+    struct Vertex
+    {
+        Coord pos;
+        int tileIndex; // -1 if terminator
+        bool primary; // is starting vertex in orthogonal axis?
+        Coord handleEnd; // <=pos: invisible, >pos: span to end pos
+    };
+
+    /*!
+     * Lines of vertices sorted by key and pos. x: {y: v} or y: {x: v}
+     *
+     * Vertices of all lines are stored in one flat array, and the i-th line
+     * refers to the range [offsets[i], offsets[i + 1]).
+     */
+    class VerticesMap
+    {
+    public:
+        template<typename V>
+        class LineRef
+        {
+        public:
+            LineRef(Coord key, V *first, V *last) : key_(key), first_(first), last_(last) { }
+
+            Coord key() const { return key_; }
+            bool empty() const { return first_ == last_; }
+            size_t size() const { return static_cast<size_t>(last_ - first_); }
+            V *begin() const { return first_; }
+            V *end() const { return last_; }
+
+            V *lowerBound(Coord pos) const
+            {
+                return std::lower_bound(first_, last_, pos,
+                                        [](const Vertex &v, Coord p) { return v.pos < p; });
+            }
+
+            V *find(Coord pos) const
+            {
+                const auto p = lowerBound(pos);
+                return p != last_ && p->pos == pos ? p : last_;
+            }
+
+        private:
+            Coord key_;
+            V *first_;
+            V *last_;
+        };
+
+        using Line = LineRef<Vertex>;
+        using ConstLine = LineRef<const Vertex>;
+
+        bool empty() const { return keys_.empty(); }
+        size_t size() const { return keys_.size(); }
+        Coord key(size_t index) const { return keys_.at(index); }
+        const std::vector<Coord> &keys() const { return keys_; }
+        Line line(size_t index)
+        {
+            return { keys_.at(index), vertices_.data() + offsets_.at(index),
+                     vertices_.data() + offsets_.at(index + 1) };
+        }
+        ConstLine line(size_t index) const
+        {
+            return { keys_.at(index), vertices_.data() + offsets_.at(index),
+                     vertices_.data() + offsets_.at(index + 1) };
+        }
+
+        /// Returns index of the first line not less than the key, or size().
+        size_t lowerBound(Coord key) const
+        {
+            return static_cast<size_t>(std::lower_bound(keys_.begin(), keys_.end(), key)
+                                       - keys_.begin());
+        }
+
+        /// Returns index of the line exactly matching the key, or size().
+        size_t find(Coord key) const
+        {
+            const size_t i = lowerBound(key);
+            return i < keys_.size() && keys_[i] == key ? i : keys_.size();
+        }
+
+        void clear();
+        template<typename F>
+        void build(size_t tileCount, F tileSpanAt);
+        void shiftTileIndices(size_t from, int delta);
+        void writeSnapshot(QByteArray &data) const;
+        template<typename F>
+        bool readSnapshot(const char *&data, const char *end, size_t tileCount, F tileSpanAt);
+        template<typename F>
+        void updateLines(const std::vector<int> &changedTiles,
+                         std::vector<std::tuple<Coord, Coord>> &keyRanges, F tileSpanAt,
+                         std::vector<size_t> &dirtyLines);
+
+        bool operator==(const VerticesMap &other) const;
+        bool operator!=(const VerticesMap &other) const { return !(*this == other); }
+
+    private:
+        static constexpr int removedTileIndex = -2;
+
+        struct Span
+        {
+            Coord pos;
+            size_t tileIndex;
+            size_t line0, line1;
+        };
+
+        void insertLine(size_t index, Coord key);
+        void eraseLine(size_t index);
+        void replaceLine(size_t index, const std::vector<Vertex> &vertices);
+
+        std::vector<Coord> keys_;
+        std::vector<size_t> offsets_; // keys_.size() + 1 if not empty
+        std::vector<Vertex> vertices_;
+        // Scratch buffers of build() and updateLines(), reused across calls.
+        std::vector<Span> spans_;
+        std::vector<size_t> cursors_;
+        std::vector<Coord> dirtyKeys_;
+        std::vector<Vertex> primaryVertices_;
+        std::vector<Vertex> spanningVertices_;
+        std::vector<Vertex> lineVertices_;
+    };
+
+    /// Pixel geometry of the tile item and handles. Handle rect is nullopt if hidden.
+    struct PixelRects
+    {
+        QRectF item;
+        std::optional<QRectF> horizontalHandle;
+        std::optional<QRectF> verticalHandle;
+    };
+
+    size_t count() const { return tileRects_.size(); }
+    NormRect tileRectAt(size_t index) const { return toNormRect(tileRects_.at(index)); }
+    std::vector<NormRect> tileRects() const;
+    const QSizeF &minimumSizeAt(size_t index) const { return minimumSizes_.at(index); }
+    void setMinimumSize(size_t index, const QSizeF &pixelSize);
+    bool isCollapsible(size_t index) const { return tilesCollapsible_.at(index); }
+    /// Incremented on every change including the minimum sizes and the moving state.
+    quint64 revision() const { return revision_; }
+    /// Incremented when tiles are inserted, removed, or replaced.
+    quint64 indexRevision() const { return indexRevision_; }
+
+    static bool isValidLayout(const std::vector<NormRect> &rects);
+    void loadTiles(const std::vector<NormRect> &rects);
+    QByteArray saveSnapshot() const;
+    bool loadSnapshot(const char *data, size_t size);
+    void assignTiles(const FlexTileGeometry &other);
+
+    void split(size_t index, Qt::Orientation orientation, size_t newCount, const QSizeF &snapSize);
+    int close(size_t index);
+
+    bool isMoving() const;
+    void startMoving(size_t index, Qt::Orientations orientations, bool lineThrough,
+                     const QRectF &outerPixelRect, const QSizeF &handlePixelSize);
+    void moveTo(const QPointF &normPos, const QSizeF &snapSize);
+    void resetMovingState();
+
+    void calculatePixelRects(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                             std::vector<PixelRects> &pixelRects);
+    int tileAt(const QPointF &pixelPos, const QRectF &outerPixelRect,
+               const QSizeF &handlePixelSize) const;
+    std::tuple<int, Qt::Orientations> handleAt(const QPointF &pixelPos,
+                                               const QRectF &outerPixelRect,
+                                               const QSizeF &handlePixelSize) const;
+    static QPointF mapToPixel(const QPointF &normPos, const QRectF &outerPixelRect);
+
+    bool verifyVerticesMap() const;
+
+private:
+    struct AdjacentIndices
+    {
+        std::vector<int> left;
+        std::vector<int> right;
+        std::vector<int> top;
+        std::vector<int> bottom;
+    };
+
+    struct ChangedTile
+    {
+        int index; // -1 if removed
+        std::optional<KeyRect> oldRect; // nullopt if inserted
+    };
+
+    /// Pixel positions of the vertices-map lines, by line index.
+    struct LinePixels
+    {
+        quint64 revision = 0;
+        QRectF outerPixelRect;
+        QSizeF handlePixelSize;
+        std::vector<qreal> xs; // of xyVerticesMap_ lines
+        std::vector<qreal> ys; // of yxVerticesMap_ lines
+    };
+
+    AdjacentIndices collectAdjacentTiles(size_t index, Qt::Orientations orientations) const;
+    AdjacentIndices collectAdjacentTilesThrough(size_t index, Qt::Orientations orientations) const;
+    static NormRect toNormRect(const KeyRect &rect);
+    static KeyRect fromNormRect(const NormRect &rect);
+    static bool isValidKeyLayout(const std::vector<KeyRect> &rects);
+    KeyRect calculateMovableKeyRect(size_t index, const AdjacentIndices &adjacentIndices,
+                                    const QRectF &outerPixelRect,
+                                    const QSizeF &handlePixelSize) const;
+    void moveAdjacentTiles(const AdjacentIndices &indices, Coord x, Coord y);
+    void ensureVerticesMapBuilt();
+    static void buildVerticesMaps(const std::vector<KeyRect> &rects, VerticesMap &xyVerticesMap,
+                                  VerticesMap &yxVerticesMap, std::vector<bool> &tilesCollapsible);
+    void updateVerticesMap(size_t shiftFrom, int shiftDelta,
+                           const std::vector<ChangedTile> &changedTiles);
+    bool calculateLinePixels(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                             LinePixels &linePixels) const;
+    const LinePixels &linePixelsFor(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                                    LinePixels &buffer) const;
+
+    std::vector<KeyRect> tileRects_; // these points can be used as map keys
+    std::vector<QSizeF> minimumSizes_; // in pixels, by tile index
+    // Built by ensureVerticesMapBuilt(), and then updated by updateVerticesMap().
+    VerticesMap xyVerticesMap_; // x: {y: v}
+    VerticesMap yxVerticesMap_; // y: {x: v}
+    std::vector<bool> tilesCollapsible_; // by tile index
+    AdjacentIndices movingTiles_;
+    KeyRect movableKeyRect_ = {}; // range of the moving x0/y0, empty if x1 <= x0 or y1 <= y0
+    std::vector<Coord> preMoveXKeys_; // sorted line keys of xyVerticesMap_ at startMoving()
+    std::vector<Coord> preMoveYKeys_; // sorted line keys of yxVerticesMap_ at startMoving()
+    LinePixels linePixels_; // calculated by the last calculatePixelRects()
+    // Scratch buffers of calculatePixelRects(), reused across calls.
+    std::vector<Coord> edgeKeys_;
+    std::vector<qreal> edgePixels_;
+    // Scratch buffers of moveAdjacentTiles() and updateVerticesMap(), reused across
+    // calls so that dragging a border doesn't allocate in the steady state.
+    std::vector<ChangedTile> changedTiles_;
+    std::vector<int> changedIndices_;
+    std::vector<std::tuple<Coord, Coord>> xyKeyRanges_;
+    std::vector<std::tuple<Coord, Coord>> yxKeyRanges_;
+    std::vector<size_t> xyDirtyLines_;
+    std::vector<size_t> yxDirtyLines_;
+    std::vector<int> dirtyTiles_;
+    // Scratch buffers of verifyVerticesMap(), reused so the debug check doesn't allocate.
+    mutable VerticesMap verifiedXyVerticesMap_;
+    mutable VerticesMap verifiedYxVerticesMap_;
+    mutable std::vector<bool> verifiedTilesCollapsible_;
+    quint64 revision_ = 0;
+    quint64 indexRevision_ = 0;
+};
@@ -1,646 +1,345 @@
-#include <QMouseEvent>
-#include <algorithm>
-#include <array>
-#include <cmath>
 #include <iterator>
-#include <limits>
 #include <numeric>
+#include <utility>
 #include "flextilelayouter.h"
 #include "flextiler.h"
 
 namespace {
-// Minimum viable width/height of tile in normalized coordinates. Zero-sized
-// tile is invalid since it would make the vertices map structure corrupted.
-// The exact value isn't important and is just copied from qFuzzyIsNull().
-constexpr qreal epsilonTileSize = sizeof(qreal) >= 8 ? 0.000000000001 : 0.00001;
+/*!
+ * Moves and resizes the item unless it is known to be placed at the rect already.
+ *
+ * The item is shown when it is placed for the first time, since it may have been
+ * hidden by FlexTileLayouter::hideUnplacedItems().
+ */
+bool updateItemGeometry(QQuickItem *item, std::optional<QRectF> &appliedRect, const QRectF &rect)
+{
+    if (appliedRect == rect)
+        return false;
+    if (!appliedRect) {
+        item->setVisible(true);
+    }
+    item->setPosition(rect.topLeft());
+    item->setSize(rect.size());
+    appliedRect = rect;
+    return true;
+}
 
-FlexTilerAttached *tileAttached(const QQuickItem *item)
+/// Shows and places the handle item unless it is known to be placed at the rect already.
+bool updateHandleGeometry(QQuickItem *item, std::optional<QRectF> &appliedRect, const QRectF &rect)
 {
-    if (!item)
-        return nullptr;
-    return qobject_cast<FlexTilerAttached *>(qmlAttachedPropertiesObject<FlexTiler>(item));
+    if (appliedRect == rect)
+        return false;
+    item->setVisible(true);
+    item->setPosition(rect.topLeft());
+    item->setSize(rect.size());
+    appliedRect = rect;
+    return true;
 }
 
-qreal snapToVertices(const FlexTileLayouter::VerticesMap &verticesMap, qreal key, qreal epsilon)
+/// Returns references to (item, context, applied pixel rect) of the tile handle.
+std::tuple<FlexTileLayouter::UniqueItemPtr &, std::unique_ptr<QQmlContext> &,
+           std::optional<QRectF> &>
+handleFields(FlexTileLayouter::Tile &tile, Qt::Orientation orientation)
 {
-    const auto start = verticesMap.lower_bound(key - epsilon);
-    if (start == verticesMap.end())
-        return key;
-    qreal bestKey = start->first;
-    qreal bestDistance = std::abs(start->first - key);
-    for (auto p = std::next(start); p != verticesMap.end(); ++p) {
-        const qreal d = std::abs(p->first - key);
-        if (d > bestDistance)
-            break;
-        bestKey = p->first;
-        bestDistance = d;
-    }
-    return bestDistance <= epsilon ? bestKey : key;
+    if (orientation == Qt::Horizontal)
+        return { tile.horizontalHandleItem, tile.horizontalHandleContext,
+                 tile.horizontalHandlePixelRect };
+    return { tile.verticalHandleItem, tile.verticalHandleContext, tile.verticalHandlePixelRect };
 }
 }
 
 FlexTileLayouter::FlexTileLayouter()
 {
-    tiles_.push_back({ { 0.0, 0.0, 1.0, 1.0 }, {}, {}, {}, {}, {}, {} });
+    replaceTiles(geometry_.count(), nullptr);
 }
 
 FlexTileLayouter::~FlexTileLayouter()
 {
     // Delete child items immediately. This should be safe since the owner itself
     // is an Item, which shouldn't be destroyed while its signal handling is
-    // in progress. See also ItemDeleter.
+    // in progress. See also ItemDeleter. Unused slots have no items.
     for (auto &tile : tiles_) {
         delete tile.item.release();
         delete tile.horizontalHandleItem.release();
         delete tile.verticalHandleItem.release();
     }
-}
-
-std::tuple<int, Qt::Orientations>
-FlexTileLayouter::findTileByHandleItem(const QQuickItem *item) const
-{
-    if (!item)
-        return { -1, {} };
-    for (size_t i = 0; i < tiles_.size(); ++i) {
-        const auto &tile = tiles_.at(i);
-        if (tile.horizontalHandleItem.get() == item)
-            return { static_cast<int>(i), Qt::Horizontal };
-        if (tile.verticalHandleItem.get() == item)
-            return { static_cast<int>(i), Qt::Vertical };
-        // If we had a corner handle, orientations would be Qt::Horizontal | Qt::Vertical.
+    for (auto *handles : { &parkedHorizontalHandles_, &parkedVerticalHandles_ }) {
+        for (auto &h : *handles) {
+            delete h.item.release();
+        }
     }
-    return { -1, {} };
 }
 
-void FlexTileLayouter::split(size_t index, Qt::Orientation orientation,
-                             std::vector<Tile> &&newTiles, const QSizeF &snapSize)
+/// Replaces the item and context of the specified tile. Handle items are kept.
+void FlexTileLayouter::replaceTileItem(size_t index, UniqueItemPtr item,
+                                       std::unique_ptr<QQmlContext> context,
+                                       FlexTilerAttached *attached)
 {
-    resetMovingState();
-    ensureVerticesMapBuilt();
-
-    // Insert new tile and adjust indices. Unchanged (x, y) values must be preserved.
-    // New borders may snap to existing vertices, but shouldn't move excessively compared
-    // to the tile width/height. Otherwise the tiles would be stacked.
-    const auto origRect = tiles_.at(index).normRect;
-    if (orientation == Qt::Horizontal) {
-        const qreal w = (origRect.x1 - origRect.x0) / static_cast<qreal>(newTiles.size() + 1);
-        const qreal e = std::min(snapSize.width(), 0.1 * w);
-        Q_ASSERT(w >= epsilonTileSize);
-        std::vector<qreal> xs;
-        for (size_t i = 0; i < newTiles.size(); ++i) {
-            xs.push_back(
-                    snapToVertices(xyVerticesMap_, origRect.x0 + static_cast<qreal>(i + 1) * w, e));
-        }
-        xs.push_back(origRect.x1);
-
-        tiles_.at(index).normRect.x1 = xs.at(0);
-        for (size_t i = 0; i < newTiles.size(); ++i) {
-            const qreal x0 = xs.at(i);
-            const qreal x1 = xs.at(i + 1);
-            newTiles.at(i).normRect = { x0, origRect.y0, x1, origRect.y1 };
-        }
-    } else {
-        const qreal h = (origRect.y1 - origRect.y0) / static_cast<qreal>(newTiles.size() + 1);
-        const qreal e = std::min(snapSize.height(), 0.1 * h);
-        Q_ASSERT(h >= epsilonTileSize);
-        std::vector<qreal> ys;
-        for (size_t i = 0; i < newTiles.size(); ++i) {
-            ys.push_back(
-                    snapToVertices(yxVerticesMap_, origRect.y0 + static_cast<qreal>(i + 1) * h, e));
-        }
-        ys.push_back(origRect.y1);
-
-        tiles_.at(index).normRect.y1 = ys.at(0);
-        for (size_t i = 0; i < newTiles.size(); ++i) {
-            const qreal y0 = ys.at(i);
-            const qreal y1 = ys.at(i + 1);
-            newTiles.at(i).normRect = { origRect.x0, y0, origRect.x1, y1 };
-        }
-    }
-
-    tiles_.insert(tiles_.begin() + static_cast<ptrdiff_t>(index) + 1,
-                  std::make_move_iterator(newTiles.begin()),
-                  std::make_move_iterator(newTiles.end()));
-
-    invalidateVerticesMap();
+    auto &tile = mutableTileAt(index);
+    tile.item = std::move(item);
+    tile.context = std::move(context);
+    tile.attached = attached;
+    tile.itemPixelRect.reset();
+    updateTileMinimumSize(index);
 }
 
-/*!
- * Closes the specified tile and collapses the adjacent tiles to fill the area.
- *
- * Returns index of one of the tiles filled the closed area, or -1 if the tile
- * couldn't be collapsed to any of the adjacent tiles.
- */
-int FlexTileLayouter::close(size_t index)
+/// Adds hidden handle item which will be reused by resizeTiles().
+void FlexTileLayouter::parkHandleItem(Qt::Orientation orientation, UniqueItemPtr item,
+                                      std::unique_ptr<QQmlContext> context)
 {
-    resetMovingState();
-    ensureVerticesMapBuilt();
-
-    const auto collectLine = [](auto linep, qreal pos0, qreal pos1) -> std::vector<int> {
-        std::vector<int> indices;
-        auto vp = linep->second.find(pos0);
-        for (; vp != linep->second.end() && vp->first < pos1; ++vp) {
-            Q_ASSERT(vp->second.tileIndex >= 0);
-            indices.push_back(vp->second.tileIndex);
-        }
-        if (vp == linep->second.end() || vp->first > pos1)
-            return {}; // unaligned tiles
-        return indices;
-    };
-
-    const auto collectPrev = [collectLine](const VerticesMap &verticesMap, qreal key0, qreal pos0,
-                                           qreal pos1) -> std::vector<int> {
-        const auto linep = verticesMap.find(key0);
-        if (linep == verticesMap.begin() || linep == verticesMap.end())
-            return {};
-        return collectLine(std::prev(linep), pos0, pos1);
-    };
-
-    const auto collectNext = [collectLine](const VerticesMap &verticesMap, qreal key1, qreal pos0,
-                                           qreal pos1) -> std::vector<int> {
-        const auto linep = verticesMap.find(key1);
-        if (linep == verticesMap.end())
-            return {};
-        return collectLine(linep, pos0, pos1);
-    };
-
-    const auto avgIndexDistance = [index](const std::vector<int> &toIndices) {
-        if (toIndices.empty())
-            return std::numeric_limits<qreal>::max();
-        const int d = std::accumulate(toIndices.begin(), toIndices.end(), 0, [index](int n, int i) {
-            return n + std::abs(i - static_cast<int>(index));
-        });
-        return static_cast<qreal>(d) / static_cast<qreal>(toIndices.size());
-    };
-
-    const auto origRect = tiles_.at(static_cast<size_t>(index)).normRect;
-    const std::array<std::vector<int>, 4> collectedIndices {
-        collectPrev(xyVerticesMap_, origRect.x0, origRect.y0, origRect.y1), // left
-        collectNext(xyVerticesMap_, origRect.x1, origRect.y0, origRect.y1), // right
-        collectPrev(yxVerticesMap_, origRect.y0, origRect.x0, origRect.x1), // top
-        collectNext(yxVerticesMap_, origRect.y1, origRect.x0, origRect.x1), // bottom
-    };
-    // If there are multiple candidates, pick the closest in the tiles vector so
-    // the tiles previously split will likely be merged.
-    auto bestIndices = collectedIndices.end();
-    qreal bestIndexDistance = std::numeric_limits<qreal>::max();
-    for (auto p = collectedIndices.begin(); p != collectedIndices.end(); ++p) {
-        const qreal d = avgIndexDistance(*p);
-        if (d >= bestIndexDistance)
-            continue;
-        bestIndices = p;
-        bestIndexDistance = d;
-    }
-    if (bestIndices == collectedIndices.end())
-        return -1;
-    Q_ASSERT(!bestIndices->empty());
-    switch (bestIndices - collectedIndices.begin()) {
-    case 0:
-        // Found left matches, which will be expanded to right.
-        for (const int i : *bestIndices) {
-            auto &tile = tiles_.at(static_cast<size_t>(i));
-            tile.normRect.x1 = origRect.x1;
-        }
-        break;
-    case 1:
-        // Found right matches, which will be expanded to left.
-        for (const int i : *bestIndices) {
-            auto &tile = tiles_.at(static_cast<size_t>(i));
-            tile.normRect.x0 = origRect.x0;
-        }
-        break;
-    case 2:
-        // Found top matches, which will be expanded to bottom.
-        for (const int i : *bestIndices) {
-            auto &tile = tiles_.at(static_cast<size_t>(i));
-            tile.normRect.y1 = origRect.y1;
-        }
-        break;
-    case 3:
-        // Found bottom matches, which will be expanded to top.
-        for (const int i : *bestIndices) {
-            auto &tile = tiles_.at(static_cast<size_t>(i));
-            tile.normRect.y0 = origRect.y0;
-        }
-        break;
-    }
-
-    tiles_.erase(tiles_.begin() + static_cast<ptrdiff_t>(index));
-
-    invalidateVerticesMap();
-    return bestIndices->front() - static_cast<int>(bestIndices->front() >= static_cast<int>(index));
+    Q_ASSERT(item && !item->isVisible());
+    auto &handles =
+            orientation == Qt::Horizontal ? parkedHorizontalHandles_ : parkedVerticalHandles_;
+    handles.push_back({ std::move(item), std::move(context) });
 }
 
-bool FlexTileLayouter::isMoving() const
+/// Deletes all handle items of the given orientation, e.g. because the component changed.
+void FlexTileLayouter::clearHandleItems(Qt::Orientation orientation)
 {
-    return !movingTiles_.left.empty() || !movingTiles_.right.empty() || !movingTiles_.top.empty()
-            || !movingTiles_.bottom.empty();
+    for (auto &tile : tiles_) {
+        auto [item, context, appliedRect] = handleFields(tile, orientation);
+        item.reset();
+        context.reset();
+        appliedRect.reset();
+    }
+    (orientation == Qt::Horizontal ? parkedHorizontalHandles_ : parkedVerticalHandles_).clear();
 }
 
-void FlexTileLayouter::startMoving(size_t index, Qt::Orientations orientations, bool lineThrough,
-                                   const QRectF &outerPixelRect, const QSizeF &handlePixelSize)
+/// Pushes the minimum size of the tile item to the geometry.
+void FlexTileLayouter::updateTileMinimumSize(size_t index)
 {
-    ensureVerticesMapBuilt();
-    movingTiles_ = lineThrough ? collectAdjacentTilesThrough(index, orientations)
-                               : collectAdjacentTiles(index, orientations);
-    movableNormRect_ =
-            calculateMovableNormRect(index, movingTiles_, outerPixelRect, handlePixelSize);
-    preMoveXyVerticesMap_ = xyVerticesMap_;
-    preMoveYxVerticesMap_ = yxVerticesMap_;
+    const auto *a = tileAt(index).attached;
+    geometry_.setMinimumSize(index,
+                             a ? QSizeF(a->minimumWidth(), a->minimumHeight()) : QSizeF(0.0, 0.0));
 }
 
-void FlexTileLayouter::moveTo(const QPointF &normPos, const QSizeF &snapSize)
+/*!
+ * Replaces all tiles at once, and builds the vertices maps from scratch.
+ *
+ * The tile rects must be validated by FlexTileGeometry::isValidLayout(). The
+ * new tiles have no items. If oldTiles is given, the current tiles are moved
+ * there instead of being destroyed. Their handle items are parked in any case.
+ */
+void FlexTileLayouter::loadTiles(const std::vector<NormRect> &rects, std::vector<Tile> *oldTiles)
 {
-    Q_ASSERT(isMoving());
-    if (movableNormRect_.isEmpty())
-        return;
-    const QPointF snappedNormPos(
-            snapToVertices(preMoveXyVerticesMap_, normPos.x(), snapSize.width()),
-            snapToVertices(preMoveYxVerticesMap_, normPos.y(), snapSize.height()));
-    const QPointF clampedNormPos(
-            std::clamp(snappedNormPos.x(), movableNormRect_.left(), movableNormRect_.right()),
-            std::clamp(snappedNormPos.y(), movableNormRect_.top(), movableNormRect_.bottom()));
-    moveAdjacentTiles(movingTiles_, clampedNormPos);
+    geometry_.loadTiles(rects);
+    replaceTiles(geometry_.count(), oldTiles);
 }
 
-void FlexTileLayouter::resetMovingState()
+/*!
+ * Replaces all tiles with the ones stored by FlexTileGeometry::saveSnapshot().
+ *
+ * The data can be a memory-mapped file. Returns false without changing the
+ * tiles if the data is malformed. See loadTiles() for oldTiles.
+ */
+bool FlexTileLayouter::loadSnapshot(const char *data, size_t size, std::vector<Tile> *oldTiles)
 {
-    movingTiles_ = {};
-    movableNormRect_ = {};
-    preMoveXyVerticesMap_.clear();
-    preMoveYxVerticesMap_.clear();
+    if (!geometry_.loadSnapshot(data, size))
+        return false;
+    replaceTiles(geometry_.count(), oldTiles);
+    return true;
 }
 
-auto FlexTileLayouter::collectAdjacentTiles(size_t index, Qt::Orientations orientations) const
-        -> AdjacentIndices
+void FlexTileLayouter::split(size_t index, Qt::Orientation orientation,
+                             std::vector<Tile> &&newTiles, const QSizeF &snapSize)
 {
-    const auto collect = [](const VerticesMap &verticesMap, qreal key1,
-                            qreal pos0) -> std::tuple<std::vector<int>, std::vector<int>> {
-        // Determine the right/bottom line from the handle item, and collect tiles
-        // within the handle span.
-        const auto line1 = verticesMap.find(key1);
-        if (line1 == verticesMap.begin() || line1 == verticesMap.end())
-            return {};
-        const auto v1s = line1->second.find(pos0);
-        if (v1s == line1->second.end())
-            return {};
-        const qreal pos1 = v1s->second.handleEnd;
-        std::vector<int> tiles1;
-        for (auto p = v1s; p != line1->second.end() && p->first < pos1; ++p) {
-            Q_ASSERT(p->second.tileIndex >= 0);
-            tiles1.push_back(p->second.tileIndex);
-        }
-
-        // Collect tiles on the adjacent left/top line within the same range.
-        const auto line0 = std::prev(line1);
-        std::vector<int> tiles0;
-        for (auto p = line0->second.find(pos0); p != line0->second.end() && p->first < pos1; ++p) {
-            Q_ASSERT(p->second.tileIndex >= 0);
-            tiles0.push_back(p->second.tileIndex);
-        }
-
-        return { tiles0, tiles1 };
-    };
+    geometry_.split(index, orientation, newTiles.size(), snapSize);
 
-    AdjacentIndices indices;
-    const auto &rect = tiles_.at(index).normRect;
-    if (orientations & Qt::Horizontal) {
-        std::tie(indices.left, indices.right) = collect(xyVerticesMap_, rect.x0, rect.y0);
+    tileIds_.insert(tileIds_.begin() + static_cast<ptrdiff_t>(index) + 1, newTiles.size(), 0);
+    for (size_t i = 0; i < newTiles.size(); ++i) {
+        const size_t id = allocateTileId(std::move(newTiles.at(i)));
+        tileIds_.at(index + 1 + i) = id;
     }
-    if (orientations & Qt::Vertical) {
-        std::tie(indices.top, indices.bottom) = collect(yxVerticesMap_, rect.y0, rect.x0);
+    updateTileIndices(index + 1);
+    for (size_t i = 0; i < newTiles.size(); ++i) {
+        updateTileMinimumSize(index + 1 + i);
     }
-
-    return indices;
 }
 
-auto FlexTileLayouter::collectAdjacentTilesThrough(size_t index,
-                                                   Qt::Orientations orientations) const
-        -> AdjacentIndices
+/*!
+ * Closes the specified tile and collapses the adjacent tiles to fill the area.
+ *
+ * Returns index of one of the tiles filled the closed area, or -1 if the tile
+ * couldn't be collapsed to any of the adjacent tiles. If closedTile is given,
+ * the removed tile is moved there instead of being destroyed. Its handle items
+ * are parked in any case.
+ */
+int FlexTileLayouter::close(size_t index, Tile *closedTile)
 {
-    const auto collect = [](const VerticesMap &verticesMap, qreal key1,
-                            qreal pos) -> std::tuple<std::vector<int>, std::vector<int>> {
-        // Walk through the line to determine contiguous range including the source item.
-        const auto line1 = verticesMap.find(key1);
-        if (line1 == verticesMap.begin() || line1 == verticesMap.end())
-            return {};
-        qreal pos0 = 1.0, pos1 = 0.0;
-        std::vector<int> tiles1;
-        for (auto p = line1->second.begin(); p != line1->second.end(); ++p) {
-            if (!p->second.primary && p->first > pos) { // reached to right/bottom edge
-                pos1 = p->first;
-                break;
-            } else if (!p->second.primary) { // not contiguous to the source item
-                pos0 = 1.0;
-                tiles1.clear();
-                continue;
-            }
-            Q_ASSERT(p->second.tileIndex >= 0);
-            if (tiles1.empty()) {
-                pos0 = p->first;
-            }
-            tiles1.push_back(p->second.tileIndex);
-        }
-
-        // Collect tiles on the adjacent left/top line within the same range.
-        const auto line0 = std::prev(line1);
-        std::vector<int> tiles0;
-        for (auto p = line0->second.find(pos0); p != line0->second.end() && p->first < pos1; ++p) {
-            Q_ASSERT(p->second.tileIndex >= 0);
-            tiles0.push_back(p->second.tileIndex);
-        }
-
-        return { tiles0, tiles1 };
-    };
+    const int collapsedToIndex = geometry_.close(index);
+    if (collapsedToIndex < 0)
+        return -1;
 
-    AdjacentIndices indices;
-    const auto &rect = tiles_.at(index).normRect;
-    if (orientations & Qt::Horizontal) {
-        std::tie(indices.left, indices.right) = collect(xyVerticesMap_, rect.x0, rect.y0);
+    releaseHandleItem(index, Qt::Horizontal);
+    releaseHandleItem(index, Qt::Vertical);
+    const size_t id = tileIds_.at(index);
+    if (closedTile) {
+        *closedTile = std::move(tiles_.at(id));
     }
-    if (orientations & Qt::Vertical) {
-        std::tie(indices.top, indices.bottom) = collect(yxVerticesMap_, rect.y0, rect.x0);
-    }
-
-    return indices;
+    tiles_.at(id) = {};
+    freeTileIds_.push_back(id);
+    tileIds_.erase(tileIds_.begin() + static_cast<ptrdiff_t>(index));
+    updateTileIndices(index);
+    return collapsedToIndex;
 }
 
-QRectF FlexTileLayouter::calculateMovableNormRect(size_t index,
-                                                  const AdjacentIndices &adjacentIndices,
-                                                  const QRectF &outerPixelRect,
-                                                  const QSizeF &handlePixelSize) const
+/// Replaces all tiles with count empty ones. The caller must update the geometry.
+void FlexTileLayouter::replaceTiles(size_t count, std::vector<Tile> *oldTiles)
 {
-    const auto minimumTileWidth = [&outerPixelRect](const Tile &tile) -> qreal {
-        const auto *a = tileAttached(tile.item.get());
-        return std::max(a ? a->minimumWidth() / outerPixelRect.width() : 0.0, epsilonTileSize);
-    };
-    const auto minimumTileHeight = [&outerPixelRect](const Tile &tile) -> qreal {
-        const auto *a = tileAttached(tile.item.get());
-        return std::max(a ? a->minimumHeight() / outerPixelRect.height() : 0.0, epsilonTileSize);
-    };
-
-    qreal left = 0.0;
-    qreal right = 1.0;
-    qreal top = 0.0;
-    qreal bottom = 1.0;
-
-    for (const auto i : adjacentIndices.left) {
-        const auto &tile = tiles_.at(static_cast<size_t>(i));
-        const qreal x = tile.normRect.x0;
-        left = std::max(x + minimumTileWidth(tile), left);
-    }
-
-    for (const auto i : adjacentIndices.right) {
-        const auto &tile = tiles_.at(static_cast<size_t>(i));
-        const qreal x = tile.normRect.x1;
-        right = std::min(x, right);
+    for (size_t i = 0; i < tileIds_.size(); ++i) {
+        releaseHandleItem(i, Qt::Horizontal);
+        releaseHandleItem(i, Qt::Vertical);
     }
 
-    for (const auto i : adjacentIndices.top) {
-        const auto &tile = tiles_.at(static_cast<size_t>(i));
-        const qreal y = tile.normRect.y0;
-        top = std::max(y + minimumTileHeight(tile), top);
-    }
-
-    for (const auto i : adjacentIndices.bottom) {
-        const auto &tile = tiles_.at(static_cast<size_t>(i));
-        const qreal y = tile.normRect.y1;
-        bottom = std::min(y, bottom);
+    if (oldTiles) {
+        oldTiles->clear();
+        oldTiles->reserve(tileIds_.size());
+        for (const size_t id : tileIds_) {
+            oldTiles->push_back(std::move(tiles_.at(id)));
+        }
     }
-
-    const auto &targetTile = tiles_.at(index);
-    const qreal marginX = handlePixelSize.width() / outerPixelRect.width();
-    const qreal marginY = handlePixelSize.height() / outerPixelRect.height();
-    return {
-        left + marginX,
-        top + marginY,
-        right - left - 2 * marginX - minimumTileWidth(targetTile),
-        bottom - top - 2 * marginY - minimumTileHeight(targetTile),
-    };
+    tiles_.clear();
+    tiles_.resize(count);
+    freeTileIds_.clear();
+    tileIds_.resize(count);
+    std::iota(tileIds_.begin(), tileIds_.end(), 0);
+    tileIndices_ = tileIds_;
 }
 
-void FlexTileLayouter::moveAdjacentTiles(const AdjacentIndices &indices, const QPointF &normPos)
+/// Stores the tile in an unused slot, and returns its ID. tileIndices_ must be updated.
+size_t FlexTileLayouter::allocateTileId(Tile &&tile)
 {
-    for (const auto i : indices.left) {
-        auto &tile = tiles_.at(static_cast<size_t>(i));
-        tile.normRect.x1 = normPos.x();
-    }
-
-    for (const auto i : indices.right) {
-        auto &tile = tiles_.at(static_cast<size_t>(i));
-        tile.normRect.x0 = normPos.x();
+    if (freeTileIds_.empty()) {
+        tiles_.push_back(std::move(tile));
+        tileIndices_.push_back(0);
+        return tiles_.size() - 1;
     }
+    const size_t id = freeTileIds_.back();
+    freeTileIds_.pop_back();
+    tiles_.at(id) = std::move(tile);
+    return id;
+}
 
-    for (const auto i : indices.top) {
-        auto &tile = tiles_.at(static_cast<size_t>(i));
-        tile.normRect.y1 = normPos.y();
+/// Rebuilds the reverse index of tileIds_ (>= from) after tiles are inserted or removed.
+void FlexTileLayouter::updateTileIndices(size_t from)
+{
+    for (size_t i = from; i < tileIds_.size(); ++i) {
+        tileIndices_[tileIds_[i]] = i;
     }
+}
 
-    for (const auto i : indices.bottom) {
-        auto &tile = tiles_.at(static_cast<size_t>(i));
-        tile.normRect.y0 = normPos.y();
+/*!
+ * Attaches a parked or newly-created handle item to the specified tile if it has none.
+ *
+ * Returns false if no handle item is available, e.g. the component is unspecified.
+ */
+bool FlexTileLayouter::ensureHandleItem(size_t index, Qt::Orientation orientation,
+                                        const HandleItemFactory &createHandleItem)
+{
+    auto [item, context, appliedRect] = handleFields(mutableTileAt(index), orientation);
+    if (item)
+        return true;
+    auto &handles =
+            orientation == Qt::Horizontal ? parkedHorizontalHandles_ : parkedVerticalHandles_;
+    if (!handles.empty()) {
+        item = std::move(handles.back().item);
+        context = std::move(handles.back().context);
+        handles.pop_back();
+    } else if (createHandleItem) {
+        std::tie(item, context) = createHandleItem(orientation);
     }
-
-    invalidateVerticesMap();
+    if (!item)
+        return false;
+    appliedRect.reset();
+    return true;
 }
 
-void FlexTileLayouter::invalidateVerticesMap()
+/*!
+ * Hides and parks the handle item of the specified tile if any.
+ *
+ * Returns true if the handle item was visible.
+ */
+bool FlexTileLayouter::releaseHandleItem(size_t index, Qt::Orientation orientation)
 {
-    xyVerticesMap_.clear();
-    yxVerticesMap_.clear();
-    tilesCollapsible_.clear();
+    auto [item, context, appliedRect] = handleFields(mutableTileAt(index), orientation);
+    if (!item)
+        return false;
+    const bool updated = appliedRect.has_value();
+    item->setVisible(false);
+    appliedRect.reset();
+    auto &handles =
+            orientation == Qt::Horizontal ? parkedHorizontalHandles_ : parkedVerticalHandles_;
+    handles.push_back({ std::move(item), std::move(context) });
+    return updated;
 }
 
-void FlexTileLayouter::ensureVerticesMapBuilt()
+/*!
+ * Moves and resizes the tile and handle items to fit the outer rect.
+ *
+ * Handle items are attached to tiles only while they are visible. Handles are
+ * taken from the parked ones, or created by createHandleItem if none.
+ */
+void FlexTileLayouter::resizeTiles(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                                   const HandleItemFactory &createHandleItem)
 {
-    if (!xyVerticesMap_.empty())
-        return;
-
-    // Collect all possible vertices.
-    Q_ASSERT(xyVerticesMap_.empty() && yxVerticesMap_.empty());
-    for (const auto &tile : tiles_) {
-        const qreal x0 = tile.normRect.x0;
-        const qreal y0 = tile.normRect.y0;
-        Q_ASSERT(0.0 <= x0 && x0 < 1.0 && 0.0 <= y0 && y0 < 1.0);
-        xyVerticesMap_.insert({ x0, {} });
-        yxVerticesMap_.insert({ y0, {} });
-    }
-
-    // Map tiles to vertices per axis
-    //
-    //       x0  xm  x1          xyVertices          yxVertices
-    //        '   '   '          x0  xm  x1
-    //            |               '   '   '
-    // y0- ---o---+---o---        A   +   B          y0- A-------B---
-    //        |       |           |   :   |
-    // ym- ---+   A   |           |   :   |          ym- +~~~~~~~+~~~
-    //        |       | B         |   :   |
-    // y1-    o-------+           C   +   |          y1- C-------+~~~
-    //        |   C   |           |   :   |
-    //
-    // xyVertices {              // describes vertical lines made by horizontal splits
-    //     x0: {y0, A}, {y1, C}  // A (x0, y0..y1), C (x0, y1..end)
-    //     xm: {y0, -}, {y1, -}
-    //     x1: {y0, B}           // B (x1, y0..end)
-    // }
-    // yxVertices {              // describes horizontal lines made by vertical splits
-    //     y0: {x0, A}, {x1, B}  // A (x0..x1, y0), B (x1..end, y0)
-    //     ym: {x0, -}, {x1, -}
-    //     y1: {x0, C}, {x1, -}  // C (x0..x1, y1)
-    // }
-    for (size_t i = 0; i < tiles_.size(); ++i) {
-        auto &tile = tiles_.at(i);
-        const qreal x0 = tile.normRect.x0;
-        const qreal x1 = tile.normRect.x1;
-        const qreal y0 = tile.normRect.y0;
-        const qreal y1 = tile.normRect.y1;
-        Q_ASSERT(x0 <= x1 && y0 <= y1);
-
-        const auto h0 = xyVerticesMap_.lower_bound(x0);
-        const auto h1 = xyVerticesMap_.lower_bound(x1);
-        for (auto p = h0; p != h1; ++p) {
-            p->second.insert({ y0, { static_cast<int>(i), p == h0, y0 } });
-        }
-
-        const auto v0 = yxVerticesMap_.lower_bound(y0);
-        const auto v1 = yxVerticesMap_.lower_bound(y1);
-        for (auto p = v0; p != v1; ++p) {
-            p->second.insert({ x0, { static_cast<int>(i), p == v0, x0 } });
-        }
-    }
-
-    // Insert terminators for convenience.
-    for (auto &[x, vertices] : xyVerticesMap_) {
-        vertices.insert({ 1.0, { -1, false, 1.0 } });
-    }
-    for (auto &[y, vertices] : yxVerticesMap_) {
-        vertices.insert({ 1.0, { -1, false, 1.0 } });
-    }
-    // Suppose we have infinite borders at right/bottom, there should be no vertices
-    // on the terminal lines.
-    xyVerticesMap_.insert({ 1.0, {} });
-    yxVerticesMap_.insert({ 1.0, {} });
-
-    // Calculate relation of adjacent tiles (e.g. handle span) per axis.
-    Q_ASSERT(tilesCollapsible_.empty());
-    tilesCollapsible_.resize(tiles_.size(), false);
-    const auto calculateAdjacentRelation = [this](VerticesMap &verticesMap) {
-        Q_ASSERT(!verticesMap.empty());
-        // First line should have no handle, so skipped updating handlePixelSize.
-        auto line0 = verticesMap.begin();
-        for (auto line1 = std::next(line0); line1 != verticesMap.end(); line0 = line1, ++line1) {
-            auto v0s = line0->second.begin();
-            auto v1s = line1->second.begin();
-            if (v0s == line0->second.end() || v1s == line1->second.end())
-                continue; // split by infinite line
-            auto v0p = std::next(v0s);
-            auto v1p = std::next(v1s);
-            int d0 = 1, d1 = 1;
-            while (v0p != line0->second.end() && v1p != line1->second.end()) {
-                // Handle can be isolated if two vertices of the adjacent lines meet.
-                if (v0p->first == v1p->first) { // should exactly match here
-                    Q_ASSERT(v0s->second.tileIndex >= 0 && v1s->second.tileIndex >= 0);
-                    v1s->second.handleEnd = v1p->first;
-                    // A single cell can be collapsed if the adjacent lines meet.
-                    const bool border = v0s->second.tileIndex != v1s->second.tileIndex;
-                    if (d0 == 1 && border) {
-                        tilesCollapsible_.at(static_cast<size_t>(v0s->second.tileIndex)) = true;
-                    }
-                    if (d1 == 1 && border) {
-                        tilesCollapsible_.at(static_cast<size_t>(v1s->second.tileIndex)) = true;
-                    }
-                    v0s = v0p;
-                    v1s = v1p;
-                    ++v0p;
-                    ++v1p;
-                    d0 = d1 = 1;
-                } else if (v0p->first < v1p->first) {
-                    ++v0p;
-                    ++d0;
-                } else {
-                    ++v1p;
-                    ++d1;
-                }
-            }
-            Q_ASSERT(v0p == line0->second.end() && v1p == line1->second.end());
-        }
-    };
-    calculateAdjacentRelation(xyVerticesMap_);
-    calculateAdjacentRelation(yxVerticesMap_);
+    geometry_.calculatePixelRects(outerPixelRect, handlePixelSize, pixelRects_);
+    applyPixelRects(geometry_, pixelRects_, createHandleItem);
 }
 
-void FlexTileLayouter::resizeTiles(const QRectF &outerPixelRect, const QSizeF &handlePixelSize)
+/*!
+ * Moves and resizes the tile and handle items to the given pixel rects.
+ *
+ * The pixel rects may be calculated from a copy of the geometry, e.g. in a worker
+ * thread, as long as the tiles haven't been inserted or removed since then. See
+ * FlexTileGeometry::indexRevision().
+ */
+void FlexTileLayouter::applyPixelRects(const FlexTileGeometry &geometry,
+                                       const std::vector<FlexTileGeometry::PixelRects> &pixelRects,
+                                       const HandleItemFactory &createHandleItem)
 {
-    ensureVerticesMapBuilt();
-
-    // Avoid sub-pixel alignment of tiles. Be aware that outerPixelRect may start
-    // from a negative point and std::round() would round it away from zero, which
-    // is not what we want.
-    const auto mapToPixelX = [&outerPixelRect](qreal x) {
-        return outerPixelRect.left() + std::round(x * outerPixelRect.width());
+    Q_ASSERT(geometry.indexRevision() == geometry_.indexRevision());
+    Q_ASSERT(pixelRects.size() == tileIds_.size());
+    const auto updateHandle = [this, &createHandleItem](size_t index, Qt::Orientation orientation,
+                                                        const std::optional<QRectF> &rect) {
+        if (!rect)
+            return releaseHandleItem(index, orientation);
+        if (!ensureHandleItem(index, orientation, createHandleItem))
+            return false;
+        auto [item, context, appliedRect] = handleFields(mutableTileAt(index), orientation);
+        return updateHandleGeometry(item.get(), appliedRect, *rect);
     };
-    const auto mapToPixelY = [&outerPixelRect](qreal y) {
-        return outerPixelRect.top() + std::round(y * outerPixelRect.height());
-    };
-
-    // TODO: fix up pixel size per minimumWidth/Height
 
-    for (const auto &[x, vertices] : xyVerticesMap_) {
-        auto v0p = vertices.begin();
-        if (v0p == vertices.end())
-            continue;
-        for (auto v1p = std::next(v0p); v1p != vertices.end(); v0p = v1p, ++v1p) {
-            Q_ASSERT(v0p->second.tileIndex >= 0);
-            // No need to update items for all of the spanned cells.
-            if (!v0p->second.primary)
-                continue;
-            const auto &tile = tiles_.at(static_cast<size_t>(v0p->second.tileIndex));
-            if (auto &item = tile.item) {
-                const qreal m = handlePixelSize.height();
-                item->setY(mapToPixelY(v0p->first) + m);
-                item->setHeight(mapToPixelY(v1p->first) - mapToPixelY(v0p->first) - m);
-            }
-            if (auto &item = tile.horizontalHandleItem) {
-                const qreal m = handlePixelSize.height();
-                item->setVisible(v0p->second.handleEnd > v0p->first);
-                item->setX(mapToPixelX(x));
-                item->setY(mapToPixelY(v0p->first) + m);
-                item->setWidth(handlePixelSize.width());
-                item->setHeight(mapToPixelY(v0p->second.handleEnd) - mapToPixelY(v0p->first) - m);
-            }
+    updatedItemCount_ = 0;
+    for (size_t i = 0; i < tileIds_.size(); ++i) {
+        const auto &rects = pixelRects.at(i);
+        if (updateHandle(i, Qt::Horizontal, rects.horizontalHandle))
+            ++updatedItemCount_;
+        if (updateHandle(i, Qt::Vertical, rects.verticalHandle))
+            ++updatedItemCount_;
+
+        auto &tile = mutableTileAt(i);
+        if (auto &item = tile.item) {
+            if (updateItemGeometry(item.get(), tile.itemPixelRect, rects.item))
+                ++updatedItemCount_;
         }
-    }
-
-    for (const auto &[y, vertices] : yxVerticesMap_) {
-        auto v0p = vertices.begin();
-        if (v0p == vertices.end())
-            continue;
-        for (auto v1p = std::next(v0p); v1p != vertices.end(); v0p = v1p, ++v1p) {
-            Q_ASSERT(v0p->second.tileIndex >= 0);
-            // No need to update items for all of the spanned cells.
-            if (!v0p->second.primary)
-                continue;
-            const auto &tile = tiles_.at(static_cast<size_t>(v0p->second.tileIndex));
-            if (auto &item = tile.item) {
-                const qreal m = handlePixelSize.width();
-                item->setX(mapToPixelX(v0p->first) + m);
-                item->setWidth(mapToPixelX(v1p->first) - mapToPixelX(v0p->first) - m);
-            }
-            if (auto &item = tile.verticalHandleItem) {
-                const qreal m = handlePixelSize.width();
-                item->setVisible(v0p->second.handleEnd > v0p->first);
-                item->setX(mapToPixelX(v0p->first) + m);
-                item->setY(mapToPixelY(y));
-                item->setWidth(mapToPixelX(v0p->second.handleEnd) - mapToPixelX(v0p->first) - m);
-                item->setHeight(handlePixelSize.height());
-            }
+        if (auto *a = tile.attached) {
+            a->setClosable(geometry.isCollapsible(i));
         }
     }
+}
 
-    for (size_t i = 0; i < tiles_.size(); ++i) {
-        const auto &tile = tiles_.at(i);
-        if (auto *a = tileAttached(tile.item.get())) {
-            a->setClosable(tilesCollapsible_.at(i));
+/*!
+ * Hides the tile items which haven't been placed yet, e.g. the items of new tiles.
+ *
+ * They are shown by the next resizeTiles() or applyPixelRects(). This is used while
+ * the layout is calculated asynchronously so that the new items wouldn't appear at
+ * the origin in the meantime.
+ */
+void FlexTileLayouter::hideUnplacedItems()
+{
+    for (auto &tile : tiles_) {
+        if (tile.item && !tile.itemPixelRect) {
+            tile.item->setVisible(false);
         }
     }
 }
@@ -4,10 +4,14 @@
 #include <QQuickItem>
 #include <QRectF>
 #include <QSizeF>
-#include <map>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <vector>
+#include "flextilegeometry.h"
+
+class FlexTilerAttached;
 
 class FlexTileLayouter
 {
@@ -24,79 +28,96 @@ public:
     };
 
     using UniqueItemPtr = std::unique_ptr<QQuickItem, ItemDeleter>;
+    using HandleItemFactory =
+            std::function<std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>>(Qt::Orientation)>;
 
-    struct KeyRect
-    {
-        qreal x0, y0;
-        qreal x1, y1;
-    };
+    using NormRect = FlexTileGeometry::NormRect;
 
     struct Tile
     {
-        // These points can be used as map keys.
-        KeyRect normRect;
         // Item and context may be nullptr if the corresponding component is unspecified
         // or invalid.
         UniqueItemPtr item;
         std::unique_ptr<QQmlContext> context;
-        // Not all tiles need horizontal/vertical handles, but handle items are created
-        // per tile to support the maximum possibility. Unused handles are just hidden.
+        FlexTilerAttached *attached = nullptr; // owned by item
+        // Handle items are attached by resizeTiles() only while they are visible.
+        // Hidden handles are parked for reuse.
         UniqueItemPtr horizontalHandleItem;
         std::unique_ptr<QQmlContext> horizontalHandleContext;
         UniqueItemPtr verticalHandleItem;
         std::unique_ptr<QQmlContext> verticalHandleContext;
+        // Geometries last applied by resizeTiles(), or nullopt if unknown. Handle
+        // geometry is nullopt while hidden.
+        std::optional<QRectF> itemPixelRect = {};
+        std::optional<QRectF> horizontalHandlePixelRect = {};
+        std::optional<QRectF> verticalHandlePixelRect = {};
     };
 
-    struct Vertex
-    {
-        int tileIndex; // -1 if terminator
-        bool primary; // is starting vertex in orthogonal axis?
-        qreal handleEnd; // <=pos: invisible, >pos: span to end pos
-    };
-
-    using VerticesMap = std::map<qreal, std::map<qreal, Vertex>>; // x: {y: v} or y: {x: v}
+    size_t count() const { return tileIds_.size(); }
+    const Tile &tileAt(size_t index) const { return tiles_.at(tileIds_.at(index)); }
+    /// Stable ID of the tile. ID of a closed tile may be reused by new tiles.
+    size_t tileIdAt(size_t index) const { return tileIds_.at(index); }
+    size_t tileIndexOf(size_t id) const { return tileIndices_.at(id); }
+    const FlexTileGeometry &geometry() const { return geometry_; }
+    void replaceTileItem(size_t index, UniqueItemPtr item, std::unique_ptr<QQmlContext> context,
+                         FlexTilerAttached *attached);
+    void updateTileMinimumSize(size_t index);
+    void parkHandleItem(Qt::Orientation orientation, UniqueItemPtr item,
+                        std::unique_ptr<QQmlContext> context);
+    void clearHandleItems(Qt::Orientation orientation);
 
-    size_t count() const { return tiles_.size(); }
-    const Tile &tileAt(size_t index) const { return tiles_.at(index); }
-    Tile &tileAt(size_t index) { return tiles_.at(index); }
-    std::tuple<int, Qt::Orientations> findTileByHandleItem(const QQuickItem *item) const;
+    void loadTiles(const std::vector<NormRect> &rects, std::vector<Tile> *oldTiles = nullptr);
+    bool loadSnapshot(const char *data, size_t size, std::vector<Tile> *oldTiles = nullptr);
 
     void split(size_t index, Qt::Orientation orientation, std::vector<Tile> &&newTiles,
                const QSizeF &snapSize);
-    int close(size_t index);
+    int close(size_t index, Tile *closedTile = nullptr);
 
-    bool isMoving() const;
+    bool isMoving() const { return geometry_.isMoving(); }
     void startMoving(size_t index, Qt::Orientations orientations, bool lineThrough,
-                     const QRectF &outerPixelRect, const QSizeF &handlePixelSize);
-    void moveTo(const QPointF &normPos, const QSizeF &snapSize);
-    void resetMovingState();
+                     const QRectF &outerPixelRect, const QSizeF &handlePixelSize)
+    {
+        geometry_.startMoving(index, orientations, lineThrough, outerPixelRect, handlePixelSize);
+    }
+    void moveTo(const QPointF &normPos, const QSizeF &snapSize)
+    {
+        geometry_.moveTo(normPos, snapSize);
+    }
+    void resetMovingState() { geometry_.resetMovingState(); }
 
-    void resizeTiles(const QRectF &outerPixelRect, const QSizeF &handlePixelSize);
+    void resizeTiles(const QRectF &outerPixelRect, const QSizeF &handlePixelSize,
+                     const HandleItemFactory &createHandleItem = {});
+    void applyPixelRects(const FlexTileGeometry &geometry,
+                         const std::vector<FlexTileGeometry::PixelRects> &pixelRects,
+                         const HandleItemFactory &createHandleItem = {});
+    void hideUnplacedItems();
+    /// Number of tile and handle items moved, resized, shown or hidden by the last resizeTiles().
+    size_t updatedItemCount() const { return updatedItemCount_; }
 
 private:
-    struct AdjacentIndices
+    struct HandleItem
     {
-        std::vector<int> left;
-        std::vector<int> right;
-        std::vector<int> top;
-        std::vector<int> bottom;
+        UniqueItemPtr item;
+        std::unique_ptr<QQmlContext> context;
     };
 
-    AdjacentIndices collectAdjacentTiles(size_t index, Qt::Orientations orientations) const;
-    AdjacentIndices collectAdjacentTilesThrough(size_t index, Qt::Orientations orientations) const;
-    QRectF calculateMovableNormRect(size_t index, const AdjacentIndices &adjacentIndices,
-                                    const QRectF &outerPixelRect,
-                                    const QSizeF &handlePixelSize) const;
-    void moveAdjacentTiles(const AdjacentIndices &indices, const QPointF &normPos);
-    void invalidateVerticesMap();
-    void ensureVerticesMapBuilt();
+    Tile &mutableTileAt(size_t index) { return tiles_.at(tileIds_.at(index)); }
+    void replaceTiles(size_t count, std::vector<Tile> *oldTiles);
+    size_t allocateTileId(Tile &&tile);
+    void updateTileIndices(size_t from);
+    bool ensureHandleItem(size_t index, Qt::Orientation orientation,
+                          const HandleItemFactory &createHandleItem);
+    bool releaseHandleItem(size_t index, Qt::Orientation orientation);
 
-    std::vector<Tile> tiles_;
-    VerticesMap xyVerticesMap_; // x: {y: v}, updated by ensureVerticesMapBuilt()
-    VerticesMap yxVerticesMap_; // y: {x: v}, updated by ensureVerticesMapBuilt()
-    std::vector<bool> tilesCollapsible_; // by tile index, updated by ensureVerticesMapBuilt()
-    AdjacentIndices movingTiles_;
-    QRectF movableNormRect_;
-    VerticesMap preMoveXyVerticesMap_;
-    VerticesMap preMoveYxVerticesMap_;
+    FlexTileGeometry geometry_;
+    // Items of geometry_ tiles are stored in slots keyed by stable tile ID, so
+    // split() and close() only have to shift the ID arrays.
+    std::vector<Tile> tiles_; // by tile ID, unused slots are empty
+    std::vector<size_t> freeTileIds_; // unused slots of tiles_
+    std::vector<size_t> tileIds_; // by tile index
+    std::vector<size_t> tileIndices_; // by tile ID, undefined for unused slots
+    std::vector<HandleItem> parkedHorizontalHandles_; // hidden, not owned by any tile
+    std::vector<HandleItem> parkedVerticalHandles_; // hidden, not owned by any tile
+    std::vector<FlexTileGeometry::PixelRects> pixelRects_; // scratch buffer for resizeTiles()
+    size_t updatedItemCount_ = 0;
 };
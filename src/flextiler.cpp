@@ -1,12 +1,84 @@
 #include <QCursor>
+#include <QDataStream>
+#include <QFile>
 #include <QHoverEvent>
 #include <QMouseEvent>
+#include <QSaveFile>
 #include <QtQml>
 #include <algorithm>
+#include <optional>
 #include "flextilelayouter.h"
 #include "flextiler.h"
+#include "tileincubator.h"
 
 namespace {
+constexpr quint32 layoutMagic = 0x464c5854; // "FLXT"
+constexpr quint32 layoutVersion = 1;
+constexpr int layoutRectSize = 4 * sizeof(double);
+
+QByteArray encodeLayout(const std::vector<FlexTileLayouter::NormRect> &rects)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << layoutMagic << layoutVersion << static_cast<quint32>(rects.size());
+    for (const auto &r : rects) {
+        out << static_cast<double>(r.x0) << static_cast<double>(r.y0)
+            << static_cast<double>(r.x1) << static_cast<double>(r.y1);
+    }
+    return data;
+}
+
+std::optional<std::vector<FlexTileLayouter::NormRect>> decodeLayout(const QByteArray &data)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != layoutMagic || version != layoutVersion)
+        return {};
+    // Don't trust the count to reserve memory.
+    if (count > static_cast<quint32>(data.size() / layoutRectSize))
+        return {};
+
+    std::vector<FlexTileLayouter::NormRect> rects;
+    rects.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        double x0, y0, x1, y1;
+        in >> x0 >> y0 >> x1 >> y1;
+        rects.push_back({ x0, y0, x1, y1 });
+    }
+    if (in.status() != QDataStream::Ok || !in.atEnd())
+        return {};
+    return rects;
+}
+
+QJsonArray encodeLayoutJson(const std::vector<FlexTileLayouter::NormRect> &rects)
+{
+    QJsonArray array;
+    for (const auto &r : rects) {
+        array.append(QJsonArray { r.x0, r.y0, r.x1, r.y1 });
+    }
+    return array;
+}
+
+std::optional<std::vector<FlexTileLayouter::NormRect>> decodeLayoutJson(const QJsonArray &array)
+{
+    std::vector<FlexTileLayouter::NormRect> rects;
+    rects.reserve(static_cast<size_t>(array.size()));
+    for (const auto &v : array) {
+        const auto a = v.toArray();
+        if (a.size() != 4 || !std::all_of(a.begin(), a.end(), [](const auto &x) {
+                return x.isDouble();
+            })) {
+            return {};
+        }
+        rects.push_back({ a.at(0).toDouble(), a.at(1).toDouble(), a.at(2).toDouble(),
+                          a.at(3).toDouble() });
+    }
+    return rects;
+}
+
 FlexTilerAttached *tileAttached(const QQuickItem *item)
 {
     if (!item)
@@ -23,9 +95,19 @@ FlexTiler::FlexTiler(QQuickItem *parent) : QQuickItem(parent)
     setAcceptedMouseButtons(Qt::LeftButton);
     setCursor(Qt::ArrowCursor);
     setFlag(ItemIsFocusScope);
+    layoutThreadPool_.setMaxThreadCount(1);
 }
 
-FlexTiler::~FlexTiler() = default;
+FlexTiler::~FlexTiler()
+{
+    layoutThreadPool_.waitForDone();
+    // Abort incubations before the placeholder items get deleted.
+    incubators_.clear();
+    // Delete pooled items immediately as FlexTileLayouter does for the active items.
+    for (auto &p : pooledItems_) {
+        delete p.item.release();
+    }
+}
 
 FlexTilerAttached *FlexTiler::qmlAttachedProperties(QObject *object)
 {
@@ -38,6 +120,8 @@ void FlexTiler::setDelegate(QQmlComponent *delegate)
         return;
 
     tileDelegate_ = delegate;
+    pooledItems_.clear();
+    incubators_.clear();
     recreateTiles();
     emit delegateChanged();
 }
@@ -47,7 +131,7 @@ void FlexTiler::setHorizontalHandle(QQmlComponent *handle)
     if (horizontalHandle_ == handle)
         return;
     horizontalHandle_ = handle;
-    recreateTiles();
+    recreateHandles(Qt::Horizontal);
     emit horizontalHandleChanged();
 }
 
@@ -56,60 +140,92 @@ void FlexTiler::setVerticalHandle(QQmlComponent *handle)
     if (verticalHandle_ == handle)
         return;
     verticalHandle_ = handle;
-    recreateTiles();
+    recreateHandles(Qt::Vertical);
     emit verticalHandleChanged();
 }
 
 void FlexTiler::recreateTiles()
 {
+    const size_t firstIncubator = incubators_.size();
     for (size_t i = 0; i < layouter_.count(); ++i) {
-        auto &tile = layouter_.tileAt(i);
-        tile = createTile(tile.normRect, static_cast<int>(i));
+        auto [item, context, attached] = createTileItem(static_cast<int>(i));
+        layouter_.replaceTileItem(i, std::move(item), std::move(context), attached);
     }
+    bindIncubatedTiles(firstIncubator, 0, layouter_.count());
     resetCurrentIndex(currentIndex_);
     polish();
 }
 
-auto FlexTiler::createTile(const KeyRect &normRect, int index) -> Tile
+/*!
+ * Deletes the existing handle items and measures the new handle size.
+ *
+ * Handle items are created on demand by the layouter. The item created here to
+ * measure the size is parked there for reuse.
+ */
+void FlexTiler::recreateHandles(Qt::Orientation orientation)
 {
-    auto [item, context] = createTileItem(index);
-    auto [hHandleItem, hHandleContext] = createHandleItem(horizontalHandle_);
-    auto [vHandleItem, vHandleContext] = createHandleItem(verticalHandle_);
+    layouter_.clearHandleItems(orientation);
+    auto [item, context] = createHandleItem(orientation);
     // Apply identical width/height to all handles to make the layouter simple.
-    horizontalHandlePixelWidth_ = hHandleItem ? hHandleItem->implicitWidth() : 0.0;
-    verticalHandlePixelHeight_ = vHandleItem ? vHandleItem->implicitHeight() : 0.0;
-    return {
-        normRect,
-        std::move(item),
-        std::move(context),
-        std::move(hHandleItem),
-        std::move(hHandleContext),
-        std::move(vHandleItem),
-        std::move(vHandleContext),
-    };
+    if (orientation == Qt::Horizontal) {
+        horizontalHandlePixelWidth_ = item ? item->implicitWidth() : 0.0;
+    } else {
+        verticalHandlePixelHeight_ = item ? item->implicitHeight() : 0.0;
+    }
+    if (item) {
+        layouter_.parkHandleItem(orientation, std::move(item), std::move(context));
+    }
+    polish();
+}
+
+auto FlexTiler::createTile(int index) -> Tile
+{
+    auto [item, context, attached] = createTileItem(index);
+    return { std::move(item), std::move(context), attached, {}, {}, {}, {} };
 }
 
-auto FlexTiler::createTileItem(int index) -> std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>>
+auto FlexTiler::createTileItem(int index)
+        -> std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
 {
+    if (!pooledItems_.empty()) {
+        auto [item, context, attached] = std::move(pooledItems_.back());
+        pooledItems_.pop_back();
+        item->setVisible(true);
+        if (attached) {
+            attached->setIndex(index);
+            emit attached->reused();
+        }
+        return { std::move(item), std::move(context), attached };
+    }
+
     if (!tileDelegate_)
         return {};
+    if (asynchronous_)
+        return incubateTileItem(index);
+    return createComponentItem(tileDelegate_, index);
+}
 
+/// Creates tile or placeholder item synchronously.
+auto FlexTiler::createComponentItem(QQmlComponent *component, int index)
+        -> std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
+{
     // See qquicksplitview.cpp
-    auto *creationContext = tileDelegate_->creationContext();
+    auto *creationContext = component->creationContext();
     if (!creationContext)
         creationContext = qmlContext(this);
     auto context = std::make_unique<QQmlContext>(creationContext);
     context->setContextObject(this);
 
-    auto *obj = tileDelegate_->beginCreate(context.get());
+    auto *obj = component->beginCreate(context.get());
     if (auto item = UniqueItemPtr(qobject_cast<QQuickItem *>(obj))) {
         item->setParentItem(this);
-        if (auto *a = tileAttached(item.get())) {
-            a->setTiler(this);
-            a->setIndex(index);
+        auto *attached = tileAttached(item.get());
+        if (attached) {
+            attached->setTiler(this);
+            attached->setIndex(index);
         }
-        tileDelegate_->completeCreate();
-        return { std::move(item), std::move(context) };
+        component->completeCreate();
+        return { std::move(item), std::move(context), attached };
     } else {
         qmlWarning(this) << "tile component does not create an item";
         delete obj;
@@ -117,9 +233,154 @@ auto FlexTiler::createTileItem(int index) -> std::tuple<UniqueItemPtr, std::uniq
     }
 }
 
-auto FlexTiler::createHandleItem(QQmlComponent *component)
+/*!
+ * Starts incubating tile item, and returns placeholder item to be laid out meanwhile.
+ *
+ * The placeholder is replaced by the tile item when the incubation completes.
+ * If no placeholder component is specified, an empty item is used instead.
+ */
+auto FlexTiler::incubateTileItem(int index)
+        -> std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
+{
+    std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *> placeholder;
+    if (placeholder_) {
+        placeholder = createComponentItem(placeholder_, index);
+    }
+    auto &placeholderItem = std::get<0>(placeholder);
+    if (!placeholderItem) {
+        placeholderItem.reset(new QQuickItem(this));
+    }
+
+    // See qquicksplitview.cpp
+    auto *creationContext = tileDelegate_->creationContext();
+    if (!creationContext)
+        creationContext = qmlContext(this);
+    auto context = std::make_unique<QQmlContext>(creationContext);
+    context->setContextObject(this);
+
+    auto incubator = std::make_unique<TileIncubator>(
+            std::move(context), placeholderItem.get(),
+            [this](TileIncubator *incubator, QObject *object) {
+                initializeIncubatedItem(incubator, object);
+            },
+            [this](TileIncubator *incubator) { finishIncubation(incubator); });
+    tileDelegate_->create(*incubator, incubator->context());
+    if (incubator->isError()) {
+        qmlWarning(this) << incubator->errors();
+        return {};
+    }
+    if (incubator->isReady()) {
+        // Completed synchronously, e.g. nested in another incubation.
+        auto *obj = incubator->object();
+        if (auto item = UniqueItemPtr(qobject_cast<QQuickItem *>(obj))) {
+            auto *attached = tileAttached(item.get());
+            if (attached) {
+                attached->setIndex(index);
+            }
+            return { std::move(item), incubator->takeContext(), attached };
+        } else {
+            qmlWarning(this) << "tile component does not create an item";
+            delete obj;
+            return {};
+        }
+    }
+    incubators_.push_back(std::move(incubator));
+    return placeholder;
+}
+
+void FlexTiler::initializeIncubatedItem(TileIncubator *incubator, QObject *object)
+{
+    auto *item = qobject_cast<QQuickItem *>(object);
+    if (!item)
+        return;
+    item->setParentItem(this);
+    if (auto *a = tileAttached(item)) {
+        a->setTiler(this);
+        // Not laid out yet if completed synchronously. See incubateTileItem().
+        const int id = incubator->tileSlot();
+        if (id >= 0) {
+            a->setIndex(static_cast<int>(layouter_.tileIndexOf(static_cast<size_t>(id))));
+        }
+    }
+}
+
+/// Replaces the placeholder with the incubated item.
+void FlexTiler::finishIncubation(TileIncubator *incubator)
+{
+    const int id = incubator->tileSlot();
+    if (id < 0)
+        return; // failed within create(), handled by incubateTileItem()
+    const int index = static_cast<int>(layouter_.tileIndexOf(static_cast<size_t>(id)));
+    Q_ASSERT(layouter_.tileAt(static_cast<size_t>(index)).item.get() == incubator->placeholder());
+
+    if (incubator->isReady()) {
+        auto *obj = incubator->object();
+        if (auto *item = qobject_cast<QQuickItem *>(obj)) {
+            auto *attached = tileAttached(item);
+            if (attached) {
+                attached->setIndex(index);
+            }
+            layouter_.replaceTileItem(static_cast<size_t>(index), UniqueItemPtr(item),
+                                      incubator->takeContext(), attached);
+        } else {
+            qmlWarning(this) << "tile component does not create an item";
+            delete obj;
+            layouter_.replaceTileItem(static_cast<size_t>(index), {}, {}, nullptr);
+        }
+    } else {
+        qmlWarning(this) << incubator->errors();
+        layouter_.replaceTileItem(static_cast<size_t>(index), {}, {}, nullptr);
+    }
+
+    if (index == currentIndex_) {
+        emit currentItemChanged();
+    }
+    polish();
+    if (std::none_of(incubators_.begin(), incubators_.end(),
+                     [](const auto &i) { return i->isLoading(); })) {
+        emit tilesReady();
+    }
+}
+
+/// Aborts the incubation of the tile item if the given item is its placeholder.
+bool FlexTiler::cancelIncubation(const QQuickItem *placeholder)
+{
+    const auto p =
+            std::find_if(incubators_.begin(), incubators_.end(), [placeholder](const auto &i) {
+                return i->isLoading() && i->placeholder() == placeholder;
+            });
+    if (p == incubators_.end())
+        return false;
+    incubators_.erase(p);
+    if (std::none_of(incubators_.begin(), incubators_.end(),
+                     [](const auto &i) { return i->isLoading(); })) {
+        emit tilesReady();
+    }
+    return true;
+}
+
+/*!
+ * Records the stable IDs of the tiles [from, to) to the incubators of their placeholders.
+ *
+ * The incubators started since firstIncubator should be in tile order. The IDs
+ * don't change until the tiles are closed, which cancels the incubations.
+ */
+void FlexTiler::bindIncubatedTiles(size_t firstIncubator, size_t from, size_t to)
+{
+    auto p = incubators_.begin() + static_cast<std::ptrdiff_t>(firstIncubator);
+    for (size_t i = from; i < to && p != incubators_.end(); ++i) {
+        if (layouter_.tileAt(i).item.get() != (*p)->placeholder())
+            continue; // created synchronously or reused
+        (*p)->setTileSlot(static_cast<int>(layouter_.tileIdAt(i)));
+        ++p;
+    }
+    Q_ASSERT(p == incubators_.end());
+}
+
+auto FlexTiler::createHandleItem(Qt::Orientation orientation)
         -> std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>>
 {
+    auto *component = (orientation == Qt::Horizontal ? horizontalHandle_ : verticalHandle_).get();
     if (!component)
         return {};
 
@@ -143,15 +404,41 @@ auto FlexTiler::createHandleItem(QQmlComponent *component)
     }
 }
 
+/// Hides the item of the closed tile and keeps it for reuse, or destroys it if !reuseItems.
+void FlexTiler::poolTileItem(Tile &&tile)
+{
+    if (!reuseItems_ || !tile.item)
+        return; // destroyed with the tile
+    tile.item->setVisible(false);
+    if (auto *a = tile.attached) {
+        a->setIndex(-1);
+        emit a->pooled();
+    }
+    pooledItems_.push_back({ std::move(tile.item), std::move(tile.context), tile.attached });
+}
+
 void FlexTiler::updateTileIndices(int from)
 {
+    if (updateDepth_ > 0) {
+        updateIndicesFrom_ = updateIndicesFrom_ < 0 ? from : std::min(updateIndicesFrom_, from);
+        return;
+    }
     for (size_t i = static_cast<size_t>(from); i < layouter_.count(); ++i) {
-        if (auto *a = tileAttached(layouter_.tileAt(i).item.get())) {
+        if (auto *a = layouter_.tileAt(i).attached) {
             a->setIndex(static_cast<int>(i));
         }
     }
 }
 
+void FlexTiler::updateTileMinimumSize(int index)
+{
+    if (index < 0 || index >= static_cast<int>(layouter_.count()))
+        return; // pooled or being incubated
+    if (updateIndicesFrom_ >= 0 && index >= updateIndicesFrom_)
+        return; // index may be outdated, pushed by endUpdate()
+    layouter_.updateTileMinimumSize(static_cast<size_t>(index));
+}
+
 int FlexTiler::count() const
 {
     return static_cast<int>(layouter_.count());
@@ -162,12 +449,21 @@ void FlexTiler::setCurrentIndex(int index)
     if (currentIndex_ == index)
         return;
     currentIndex_ = index;
+    if (updateDepth_ > 0) {
+        currentItemDirty_ = true;
+        return;
+    }
     emit currentIndexChanged();
     emit currentItemChanged();
 }
 
 void FlexTiler::resetCurrentIndex(int index)
 {
+    if (updateDepth_ > 0) {
+        currentIndex_ = index;
+        currentItemDirty_ = true;
+        return;
+    }
     if (currentIndex_ != index) {
         currentIndex_ = index;
         emit currentIndexChanged();
@@ -180,6 +476,51 @@ QQuickItem *FlexTiler::currentItem() const
     return currentIndex_ >= 0 ? itemAt(currentIndex_) : nullptr;
 }
 
+void FlexTiler::setReuseItems(bool reuse)
+{
+    if (reuseItems_ == reuse)
+        return;
+    reuseItems_ = reuse;
+    if (!reuseItems_) {
+        pooledItems_.clear();
+    }
+    emit reuseItemsChanged();
+}
+
+void FlexTiler::setAsynchronous(bool asynchronous)
+{
+    if (asynchronous_ == asynchronous)
+        return;
+    asynchronous_ = asynchronous;
+    emit asynchronousChanged();
+}
+
+void FlexTiler::setPlaceholder(QQmlComponent *placeholder)
+{
+    if (placeholder_ == placeholder)
+        return;
+    placeholder_ = placeholder;
+    emit placeholderChanged();
+}
+
+/*!
+ * Enables the layout computation in a worker thread.
+ *
+ * The pixel rects are calculated from a copy of the tile rects, and applied to the
+ * items later. In the meantime, the items stay at the last published layout, and
+ * hit tests and drags are answered against it. See appliedLayout(). The items of
+ * new tiles, e.g. created by split(), are hidden until they are laid out.
+ */
+void FlexTiler::setAsynchronousLayout(bool asynchronous)
+{
+    if (asynchronousLayout_ == asynchronous)
+        return;
+    asynchronousLayout_ = asynchronous;
+    appliedLayoutJob_.reset();
+    polish();
+    emit asynchronousLayoutChanged();
+}
+
 QQuickItem *FlexTiler::itemAt(int index) const
 {
     if (index < 0 || index >= static_cast<int>(layouter_.count())) {
@@ -190,6 +531,29 @@ QQuickItem *FlexTiler::itemAt(int index) const
     return layouter_.tileAt(static_cast<size_t>(index)).item.get();
 }
 
+/*!
+ * Returns index of the tile at the given position, or -1 if none.
+ *
+ * The tile area includes its left and top handles.
+ */
+int FlexTiler::tileAt(const QPointF &position) const
+{
+    const auto [geometry, outerPixelRect, handlePixelSize] = appliedLayout();
+    return geometry ? geometry->tileAt(position, outerPixelRect, handlePixelSize) : -1;
+}
+
+/*!
+ * Returns index of the tile whose handle of the given orientations is at the
+ * position, or -1 if none.
+ *
+ * This is calculated from the tile geometry regardless of the handle items.
+ */
+int FlexTiler::handleAt(const QPointF &position, Qt::Orientations orientations) const
+{
+    const auto [index, handleOrientations] = findHandleAt(position);
+    return handleOrientations & orientations ? index : -1;
+}
+
 void FlexTiler::split(int index, Qt::Orientation orientation, int count)
 {
     if (index < 0 || index >= static_cast<int>(layouter_.count())) {
@@ -200,16 +564,21 @@ void FlexTiler::split(int index, Qt::Orientation orientation, int count)
         return;
 
     const int shiftedCurrentIndex = currentIndex_ + (index < currentIndex_ ? count - 1 : 0);
+    const size_t firstIncubator = incubators_.size();
     std::vector<Tile> newTiles;
     for (int i = 1; i < count; ++i) {
-        newTiles.push_back(createTile({ 0.0, 0.0, 0.0, 0.0 }, index + i));
+        newTiles.push_back(createTile(index + i));
     }
     const auto outerRect = extendedOuterPixelRect();
     const QSizeF snapSize(snapPixelSize / outerRect.width(), snapPixelSize / outerRect.height());
     layouter_.split(static_cast<size_t>(index), orientation, std::move(newTiles), snapSize);
+    bindIncubatedTiles(firstIncubator, static_cast<size_t>(index) + 1,
+                       static_cast<size_t>(index + count));
 
     updateTileIndices(index + count);
     setCurrentIndex(shiftedCurrentIndex);
+    if (updateDepth_ > 0)
+        return;
     polish();
     emit countChanged();
 }
@@ -223,11 +592,15 @@ void FlexTiler::close(int index)
 
     const bool currentClosing = index == currentIndex_;
     const int shiftedCurrentIndex = currentIndex_ - static_cast<int>(index < currentIndex_);
-    const int collapsedToIndex = layouter_.close(static_cast<size_t>(index));
+    Tile closedTile;
+    const int collapsedToIndex = layouter_.close(static_cast<size_t>(index), &closedTile);
     if (collapsedToIndex < 0) {
         qmlInfo(this) << "no collapsible tiles found for " << index;
         return;
     }
+    if (!cancelIncubation(closedTile.item.get())) {
+        poolTileItem(std::move(closedTile));
+    }
 
     updateTileIndices(index);
     if (currentClosing) {
@@ -235,10 +608,184 @@ void FlexTiler::close(int index)
     } else {
         setCurrentIndex(shiftedCurrentIndex);
     }
+    if (updateDepth_ > 0)
+        return;
     polish();
     emit countChanged();
 }
 
+/*!
+ * Starts batch of split() and close() operations.
+ *
+ * Until the matching endUpdate(), the attached index of the tiles isn't updated, and
+ * the count and current index change notifications are deferred. Minimum size changes
+ * of the tiles to be renumbered are also deferred. Calls can be nested.
+ */
+void FlexTiler::beginUpdate()
+{
+    if (updateDepth_++ > 0)
+        return;
+    preUpdateCount_ = count();
+    preUpdateCurrentIndex_ = currentIndex_;
+    currentItemDirty_ = false;
+}
+
+/// Ends batch of operations, and applies the deferred updates at once.
+void FlexTiler::endUpdate()
+{
+    if (updateDepth_ <= 0) {
+        qmlWarning(this) << "endUpdate() called without beginUpdate()";
+        return;
+    }
+    if (--updateDepth_ > 0)
+        return;
+
+    if (updateIndicesFrom_ >= 0) {
+        const int from = updateIndicesFrom_;
+        updateIndicesFrom_ = -1;
+        updateTileIndices(from);
+        // Minimum sizes of the renumbered tiles couldn't be pushed by index.
+        for (size_t i = static_cast<size_t>(from); i < layouter_.count(); ++i) {
+            layouter_.updateTileMinimumSize(i);
+        }
+    }
+    polish();
+    if (count() != preUpdateCount_) {
+        emit countChanged();
+    }
+    if (currentIndex_ != preUpdateCurrentIndex_) {
+        emit currentIndexChanged();
+    }
+    if (currentItemDirty_) {
+        emit currentItemChanged();
+        currentItemDirty_ = false;
+    }
+}
+
+/// Returns the tile rects in compact binary form.
+QByteArray FlexTiler::saveLayout() const
+{
+    return encodeLayout(layouter_.geometry().tileRects());
+}
+
+/*!
+ * Replaces all tiles with the ones stored by saveLayout().
+ *
+ * Returns false without changing the tiles if the data is invalid.
+ */
+bool FlexTiler::restoreLayout(const QByteArray &data)
+{
+    const auto rects = decodeLayout(data);
+    if (!rects) {
+        qmlWarning(this) << "malformed layout data";
+        return false;
+    }
+    return loadTileRects(*rects);
+}
+
+/// Returns the tile rects as [[x0, y0, x1, y1], ...] in normalized coordinates.
+QJsonArray FlexTiler::saveLayoutJson() const
+{
+    return encodeLayoutJson(layouter_.geometry().tileRects());
+}
+
+/// Replaces all tiles with the ones stored by saveLayoutJson().
+bool FlexTiler::restoreLayoutJson(const QJsonArray &rects)
+{
+    const auto decodedRects = decodeLayoutJson(rects);
+    if (!decodedRects) {
+        qmlWarning(this) << "malformed layout data";
+        return false;
+    }
+    return loadTileRects(*decodedRects);
+}
+
+bool FlexTiler::loadTileRects(const std::vector<NormRect> &rects)
+{
+    if (!FlexTileGeometry::isValidLayout(rects)) {
+        qmlWarning(this) << "tile rects do not exactly cover the tiler";
+        return false;
+    }
+
+    std::vector<Tile> oldTiles;
+    layouter_.loadTiles(rects, &oldTiles);
+    recreateLoadedTileItems(std::move(oldTiles));
+    return true;
+}
+
+/// Writes the tiles in the snapshot format, which can be loaded quickly.
+bool FlexTiler::saveSnapshot(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qmlWarning(this) << "failed to open " << fileName << ": " << file.errorString();
+        return false;
+    }
+    const auto data = layouter_.geometry().saveSnapshot();
+    if (file.write(data) != data.size() || !file.commit()) {
+        qmlWarning(this) << "failed to write " << fileName << ": " << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * Replaces all tiles with the ones stored by saveSnapshot().
+ *
+ * The file is memory-mapped and the vertices maps are copied without being
+ * rebuilt. Returns false without changing the tiles if the file is invalid.
+ */
+bool FlexTiler::loadSnapshot(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qmlWarning(this) << "failed to open " << fileName << ": " << file.errorString();
+        return false;
+    }
+    const qint64 size = file.size();
+    uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data) {
+        qmlWarning(this) << "failed to map " << fileName << ": " << file.errorString();
+        return false;
+    }
+    std::vector<Tile> oldTiles;
+    const bool ok = layouter_.loadSnapshot(reinterpret_cast<const char *>(data),
+                                           static_cast<size_t>(size), &oldTiles);
+    file.unmap(data);
+    if (!ok) {
+        qmlWarning(this) << "malformed snapshot " << fileName;
+        return false;
+    }
+    recreateLoadedTileItems(std::move(oldTiles));
+    return true;
+}
+
+/// Creates items for the tiles loaded by the layouter. The old items are pooled if possible.
+void FlexTiler::recreateLoadedTileItems(std::vector<Tile> &&oldTiles)
+{
+    const int oldCount = static_cast<int>(oldTiles.size());
+    for (auto &tile : oldTiles) {
+        if (!cancelIncubation(tile.item.get())) {
+            poolTileItem(std::move(tile));
+        }
+    }
+    oldTiles.clear();
+
+    const size_t firstIncubator = incubators_.size();
+    for (size_t i = 0; i < layouter_.count(); ++i) {
+        auto [item, context, attached] = createTileItem(static_cast<int>(i));
+        layouter_.replaceTileItem(i, std::move(item), std::move(context), attached);
+    }
+    bindIncubatedTiles(firstIncubator, 0, layouter_.count());
+    resetCurrentIndex(std::min(currentIndex_, count() - 1));
+    if (updateDepth_ > 0)
+        return;
+    polish();
+    if (count() != oldCount) {
+        emit countChanged();
+    }
+}
+
 void FlexTiler::hoverEnterEvent(QHoverEvent *event)
 {
     updateHovered(event->position());
@@ -256,8 +803,7 @@ void FlexTiler::hoverLeaveEvent(QHoverEvent *)
 
 void FlexTiler::updateHovered(const QPointF &position)
 {
-    const auto *item = childAt(position.x(), position.y());
-    const auto [index, orientations] = layouter_.findTileByHandleItem(item);
+    const auto [index, orientations] = findHandleAt(position);
     switch (orientations) {
     case Qt::Horizontal:
         setCursor(Qt::SplitHCursor);
@@ -275,8 +821,11 @@ void FlexTiler::updateHovered(const QPointF &position)
 
 void FlexTiler::mousePressEvent(QMouseEvent *event)
 {
-    const auto *item = childAt(event->position().x(), event->position().y());
-    const auto [index, orientations] = layouter_.findTileByHandleItem(item);
+    const auto [geometry, outerPixelRect, handlePixelSize] = appliedLayout();
+    if (!geometry)
+        return;
+    const auto [index, orientations] =
+            geometry->handleAt(event->position(), outerPixelRect, handlePixelSize);
     if (index < 0)
         return;
 
@@ -286,7 +835,10 @@ void FlexTiler::mousePressEvent(QMouseEvent *event)
     layouter_.startMoving(static_cast<size_t>(index), orientations, lineThrough,
                           extendedOuterPixelRect(),
                           { horizontalHandlePixelWidth_, verticalHandlePixelHeight_ });
-    movingHandleGrabPixelOffset_ = event->position() - item->position();
+    // Grab the handle where it is displayed.
+    const auto &rect = geometry->tileRectAt(static_cast<size_t>(index));
+    movingHandleGrabPixelOffset_ =
+            event->position() - FlexTileGeometry::mapToPixel({ rect.x0, rect.y0 }, outerPixelRect);
     setKeepMouseGrab(true);
 }
 
@@ -321,8 +873,96 @@ void FlexTiler::geometryChange(const QRectF &newGeometry, const QRectF &oldGeome
 
 void FlexTiler::updatePolish()
 {
-    layouter_.resizeTiles(extendedOuterPixelRect(),
-                          { horizontalHandlePixelWidth_, verticalHandlePixelHeight_ });
+    incubators_.erase(std::remove_if(incubators_.begin(), incubators_.end(),
+                                     [](const auto &i) { return !i->isLoading(); }),
+                      incubators_.end());
+    if (asynchronousLayout_) {
+        // New items are hidden until the layout including them is applied.
+        layouter_.hideUnplacedItems();
+        startAsynchronousLayout();
+        return;
+    }
+    layouter_.resizeTiles(
+            extendedOuterPixelRect(), { horizontalHandlePixelWidth_, verticalHandlePixelHeight_ },
+            [this](Qt::Orientation orientation) { return createHandleItem(orientation); });
+}
+
+void FlexTiler::startAsynchronousLayout()
+{
+    if (layoutRunning_) {
+        layoutPending_ = true;
+        return;
+    }
+
+    // Only the tile rects and minimum sizes are copied here. The vertices maps are
+    // rebuilt by the worker, reusing the buffers of the previous job.
+    auto job = layoutJob_;
+    job->geometry.assignTiles(layouter_.geometry());
+    job->outerPixelRect = extendedOuterPixelRect();
+    job->handlePixelSize = { horizontalHandlePixelWidth_, verticalHandlePixelHeight_ };
+    layoutRunning_ = true;
+    layoutPending_ = false;
+    layoutThreadPool_.start([this, job]() {
+        job->geometry.calculatePixelRects(job->outerPixelRect, job->handlePixelSize,
+                                          job->pixelRects);
+        QMetaObject::invokeMethod(this, &FlexTiler::finishAsynchronousLayout,
+                                  Qt::QueuedConnection);
+    });
+}
+
+void FlexTiler::finishAsynchronousLayout()
+{
+    Q_ASSERT(layoutRunning_);
+    layoutRunning_ = false;
+    if (!asynchronousLayout_)
+        return; // already laid out synchronously
+
+    // Tiles may have been changed while the job was running. The result can be applied
+    // unless they were inserted or removed, but is outdated in any case.
+    auto &job = *layoutJob_;
+    if (job.geometry.indexRevision() == layouter_.geometry().indexRevision()) {
+        layouter_.applyPixelRects(
+                job.geometry, job.pixelRects,
+                [this](Qt::Orientation orientation) { return createHandleItem(orientation); });
+        // Keep the applied layout for hit testing. The previous one is recycled by the
+        // next job.
+        if (!appliedLayoutJob_) {
+            appliedLayoutJob_ = std::make_unique<LayoutJob>();
+        }
+        std::swap(job, *appliedLayoutJob_);
+    }
+    if (layoutPending_) {
+        polish();
+    }
+}
+
+/// Returns index and orientation of the tile handle at the position.
+std::tuple<int, Qt::Orientations> FlexTiler::findHandleAt(const QPointF &position) const
+{
+    const auto [geometry, outerPixelRect, handlePixelSize] = appliedLayout();
+    if (!geometry)
+        return { -1, {} };
+    return geometry->handleAt(position, outerPixelRect, handlePixelSize);
+}
+
+/*!
+ * Returns the geometry which the items are laid out to, and its outer pixel rect
+ * and handle size.
+ *
+ * While asynchronousLayout, this is the last layout applied to the items, which
+ * may lag behind the tile geometry. Returns nullptr if the current tiles haven't
+ * been laid out yet, e.g. just after split() or close().
+ */
+std::tuple<const FlexTileGeometry *, QRectF, QSizeF> FlexTiler::appliedLayout() const
+{
+    if (!asynchronousLayout_) {
+        return { &layouter_.geometry(), extendedOuterPixelRect(),
+                 { horizontalHandlePixelWidth_, verticalHandlePixelHeight_ } };
+    }
+    const auto *job = appliedLayoutJob_.get();
+    if (!job || job->geometry.indexRevision() != layouter_.geometry().indexRevision())
+        return { nullptr, {}, {} };
+    return { &job->geometry, job->outerPixelRect, job->handlePixelSize };
 }
 
 /// Outer bounds including invisible left-top handles.
@@ -376,6 +1016,7 @@ void FlexTilerAttached::requestPolish()
 {
     if (!tiler_)
         return;
+    tiler_->updateTileMinimumSize(index_);
     tiler_->polish();
 }
 
@@ -1,15 +1,20 @@
 #pragma once
+#include <QByteArray>
+#include <QJsonArray>
 #include <QPointF>
 #include <QPointer>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QRectF>
+#include <QThreadPool>
 #include <memory>
 #include <tuple>
+#include <vector>
 #include "flextilelayouter.h"
 
 class FlexTilerAttached;
+class TileIncubator;
 
 class FlexTiler : public QQuickItem
 {
@@ -22,6 +27,13 @@ class FlexTiler : public QQuickItem
     Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
     Q_PROPERTY(int currentIndex READ currentIndex WRITE setCurrentIndex NOTIFY currentIndexChanged)
     Q_PROPERTY(QQuickItem *currentItem READ currentItem NOTIFY currentItemChanged)
+    Q_PROPERTY(bool reuseItems READ reuseItems WRITE setReuseItems NOTIFY reuseItemsChanged FINAL)
+    Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous NOTIFY
+                       asynchronousChanged FINAL)
+    Q_PROPERTY(QQmlComponent *placeholder READ placeholder WRITE setPlaceholder NOTIFY
+                       placeholderChanged FINAL)
+    Q_PROPERTY(bool asynchronousLayout READ asynchronousLayout WRITE setAsynchronousLayout NOTIFY
+                       asynchronousLayoutChanged FINAL)
     QML_ATTACHED(FlexTilerAttached)
     QML_ELEMENT
 
@@ -45,10 +57,35 @@ public:
     void setCurrentIndex(int index);
     QQuickItem *currentItem() const;
     Q_INVOKABLE QQuickItem *itemAt(int index) const;
+    Q_INVOKABLE int tileAt(const QPointF &position) const;
+    Q_INVOKABLE int handleAt(const QPointF &position,
+                             Qt::Orientations orientations = Qt::Horizontal | Qt::Vertical) const;
+
+    bool reuseItems() const { return reuseItems_; }
+    void setReuseItems(bool reuse);
+
+    bool asynchronous() const { return asynchronous_; }
+    void setAsynchronous(bool asynchronous);
+
+    QQmlComponent *placeholder() { return placeholder_; }
+    void setPlaceholder(QQmlComponent *placeholder);
+
+    bool asynchronousLayout() const { return asynchronousLayout_; }
+    void setAsynchronousLayout(bool asynchronous);
 
     Q_INVOKABLE void split(int index, Qt::Orientation orientation, int count = 2);
     Q_INVOKABLE void close(int index);
 
+    Q_INVOKABLE void beginUpdate();
+    Q_INVOKABLE void endUpdate();
+
+    Q_INVOKABLE QByteArray saveLayout() const;
+    Q_INVOKABLE bool restoreLayout(const QByteArray &data);
+    Q_INVOKABLE QJsonArray saveLayoutJson() const;
+    Q_INVOKABLE bool restoreLayoutJson(const QJsonArray &rects);
+    Q_INVOKABLE bool saveSnapshot(const QString &fileName) const;
+    Q_INVOKABLE bool loadSnapshot(const QString &fileName);
+
 signals:
     void delegateChanged();
     void horizontalHandleChanged();
@@ -56,6 +93,11 @@ signals:
     void countChanged();
     void currentIndexChanged();
     void currentItemChanged();
+    void reuseItemsChanged();
+    void asynchronousChanged();
+    void placeholderChanged();
+    void asynchronousLayoutChanged();
+    void tilesReady();
 
 protected:
     void hoverEnterEvent(QHoverEvent *event) override;
@@ -68,18 +110,51 @@ protected:
     void updatePolish() override;
 
 private:
-    using KeyRect = FlexTileLayouter::KeyRect;
+    using NormRect = FlexTileLayouter::NormRect;
     using Tile = FlexTileLayouter::Tile;
     using UniqueItemPtr = FlexTileLayouter::UniqueItemPtr;
 
+    struct PooledItem
+    {
+        UniqueItemPtr item;
+        std::unique_ptr<QQmlContext> context;
+        FlexTilerAttached *attached;
+    };
+
+    struct LayoutJob
+    {
+        FlexTileGeometry geometry; // tiles copied to be laid out by worker thread
+        QRectF outerPixelRect;
+        QSizeF handlePixelSize;
+        std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    };
+
     void recreateTiles();
-    Tile createTile(const KeyRect &normRect, int index);
-    std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>> createTileItem(int index);
+    void recreateHandles(Qt::Orientation orientation);
+    Tile createTile(int index);
+    std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
+    createTileItem(int index);
+    std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
+    createComponentItem(QQmlComponent *component, int index);
+    std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>, FlexTilerAttached *>
+    incubateTileItem(int index);
+    void initializeIncubatedItem(TileIncubator *incubator, QObject *object);
+    void finishIncubation(TileIncubator *incubator);
+    bool cancelIncubation(const QQuickItem *placeholder);
+    void bindIncubatedTiles(size_t firstIncubator, size_t from, size_t to);
     std::tuple<UniqueItemPtr, std::unique_ptr<QQmlContext>>
-    createHandleItem(QQmlComponent *component);
+    createHandleItem(Qt::Orientation orientation);
+    void poolTileItem(Tile &&tile);
     void updateTileIndices(int from);
+    void updateTileMinimumSize(int index);
+    bool loadTileRects(const std::vector<NormRect> &rects);
+    void recreateLoadedTileItems(std::vector<Tile> &&oldTiles);
     void resetCurrentIndex(int index);
     void updateHovered(const QPointF &position);
+    std::tuple<int, Qt::Orientations> findHandleAt(const QPointF &position) const;
+    std::tuple<const FlexTileGeometry *, QRectF, QSizeF> appliedLayout() const;
+    void startAsynchronousLayout();
+    void finishAsynchronousLayout();
 
     QRectF extendedOuterPixelRect() const;
 
@@ -91,6 +166,24 @@ private:
     qreal verticalHandlePixelHeight_ = 0.0;
     QPointF movingHandleGrabPixelOffset_;
     int currentIndex_ = 0; // should have at least one tile
+    std::vector<PooledItem> pooledItems_; // hidden tile items to be reused if reuseItems_
+    bool reuseItems_ = false;
+    QPointer<QQmlComponent> placeholder_ = nullptr;
+    std::vector<std::unique_ptr<TileIncubator>> incubators_; // finished ones are removed on polish
+    bool asynchronous_ = false;
+    int updateDepth_ = 0; // > 0 while in beginUpdate()/endUpdate()
+    int updateIndicesFrom_ = -1; // tile indices to be updated by endUpdate()
+    int preUpdateCount_ = 0;
+    int preUpdateCurrentIndex_ = 0;
+    bool currentItemDirty_ = false;
+    bool asynchronousLayout_ = false;
+    bool layoutRunning_ = false; // layoutJob_ is owned by worker thread
+    bool layoutPending_ = false; // polished while layoutRunning_
+    std::shared_ptr<LayoutJob> layoutJob_ = std::make_shared<LayoutJob>();
+    std::unique_ptr<LayoutJob> appliedLayoutJob_; // last one applied to the items, for hit tests
+    QThreadPool layoutThreadPool_; // must be destroyed first to wait for the running job
+
+    friend class FlexTilerAttached; // for updateTileMinimumSize()
 };
 
 class FlexTilerAttached : public QObject
@@ -128,6 +221,8 @@ signals:
     void minimumWidthChanged();
     void minimumHeightChanged();
     void closableChanged();
+    void pooled();
+    void reused();
 
 private:
     void requestPolish();
@@ -0,0 +1,25 @@
+#include "tileincubator.h"
+
+TileIncubator::TileIncubator(std::unique_ptr<QQmlContext> context, QQuickItem *placeholder,
+                             InitialStateHandler initialize, FinishedHandler finished)
+    : QQmlIncubator(Asynchronous),
+      context_(std::move(context)),
+      placeholder_(placeholder),
+      initialize_(std::move(initialize)),
+      finished_(std::move(finished))
+{
+}
+
+void TileIncubator::setInitialState(QObject *object)
+{
+    initialize_(this, object);
+}
+
+void TileIncubator::statusChanged(Status status)
+{
+    // Null is also reported when the incubation is cleared, in which case the
+    // owner may be being destroyed.
+    if (status != Ready && status != Error)
+        return;
+    finished_(this);
+}
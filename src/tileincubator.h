@@ -0,0 +1,44 @@
+#pragma once
+#include <QQmlContext>
+#include <QQmlIncubator>
+#include <QQuickItem>
+#include <functional>
+#include <memory>
+
+/*!
+ * Incubates a tile delegate asynchronously in place of a placeholder item.
+ *
+ * The finished handler is called when the incubation gets ready or fails. It
+ * must not delete the incubator since the incubator is still in use.
+ *
+ * The owner should record where the placeholder is laid out by setTileSlot() and
+ * keep it up to date, so the incubated item can be put in place without searching
+ * the tiles for the placeholder.
+ */
+class TileIncubator : public QQmlIncubator
+{
+public:
+    using InitialStateHandler = std::function<void(TileIncubator *incubator, QObject *object)>;
+    using FinishedHandler = std::function<void(TileIncubator *incubator)>;
+
+    TileIncubator(std::unique_ptr<QQmlContext> context, QQuickItem *placeholder,
+                  InitialStateHandler initialize, FinishedHandler finished);
+
+    QQmlContext *context() const { return context_.get(); }
+    std::unique_ptr<QQmlContext> takeContext() { return std::move(context_); }
+    QQuickItem *placeholder() const { return placeholder_; }
+    /// Index or stable ID of the placeholder tile, or -1 if it isn't laid out yet.
+    int tileSlot() const { return tileSlot_; }
+    void setTileSlot(int slot) { tileSlot_ = slot; }
+
+protected:
+    void setInitialState(QObject *object) override;
+    void statusChanged(Status status) override;
+
+private:
+    std::unique_ptr<QQmlContext> context_;
+    QQuickItem *placeholder_;
+    int tileSlot_ = -1;
+    InitialStateHandler initialize_;
+    FinishedHandler finished_;
+};
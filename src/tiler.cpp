@@ -4,6 +4,7 @@
 #include <QPointF>
 #include <QtQml>
 #include <algorithm>
+#include "tileincubator.h"
 #include "tiler.h"
 
 namespace {
@@ -25,7 +26,8 @@ Tiler::Tiler(QQuickItem *parent) : QQuickItem(parent)
     tiles_.push_back({ nullptr, nullptr });
     std::vector<Band> bands;
     bands.push_back({ 0, 0.0, nullptr, nullptr });
-    splitMap_.push_back({ Qt::Horizontal, std::move(bands), {}, {} });
+    splitMap_.push_back({ Qt::Horizontal, std::move(bands), {}, {}, {}, { -1, -1 }, true });
+    tileSplitBands_.push_back({ 0, 0 });
 
     setAcceptHoverEvents(true);
     setAcceptedMouseButtons(Qt::LeftButton);
@@ -35,12 +37,17 @@ Tiler::Tiler(QQuickItem *parent) : QQuickItem(parent)
 
 Tiler::~Tiler()
 {
+    // Abort incubations before the placeholder items get deleted.
+    incubators_.clear();
     // Delete child items immediately. This should be safe since the owner itself
     // is an Item, which shouldn't be destroyed while its signal handling is
     // in progress. See also ItemDeleter.
     for (auto &tile : tiles_) {
         delete tile.item.release();
     }
+    for (auto &tile : pooledTiles_) {
+        delete tile.item.release();
+    }
     for (auto &split : splitMap_) {
         for (auto &band : split.bands) {
             delete band.handleItem.release();
@@ -59,6 +66,8 @@ void Tiler::setDelegate(QQmlComponent *delegate)
         return;
 
     tileDelegate_ = delegate;
+    pooledTiles_.clear();
+    incubators_.clear();
     recreateTiles();
     emit delegateChanged();
 }
@@ -68,29 +77,48 @@ void Tiler::recreateTiles()
     for (size_t i = 0; i < tiles_.size(); ++i) {
         tiles_.at(i) = createTile(static_cast<int>(i));
     }
+    invalidateAllMinimumSizes();
     polish();
 }
 
 auto Tiler::createTile(int index) -> Tile
 {
+    if (!pooledTiles_.empty()) {
+        auto tile = std::move(pooledTiles_.back());
+        pooledTiles_.pop_back();
+        tile.item->setVisible(true);
+        if (auto *a = tileAttached(tile.item.get())) {
+            a->setIndex(index);
+            emit a->reused();
+        }
+        return tile;
+    }
+
     if (!tileDelegate_)
         return {};
+    if (asynchronous_)
+        return incubateTile(index);
+    return createComponentTile(tileDelegate_, index);
+}
 
+/// Creates tile or placeholder item synchronously.
+auto Tiler::createComponentTile(QQmlComponent *component, int index) -> Tile
+{
     // See qquicksplitview.cpp
-    auto *creationContext = tileDelegate_->creationContext();
+    auto *creationContext = component->creationContext();
     if (!creationContext)
         creationContext = qmlContext(this);
     auto context = std::make_unique<QQmlContext>(creationContext);
     context->setContextObject(this);
 
-    auto *obj = tileDelegate_->beginCreate(context.get());
+    auto *obj = component->beginCreate(context.get());
     if (auto item = std::unique_ptr<QQuickItem, ItemDeleter>(qobject_cast<QQuickItem *>(obj))) {
         item->setParentItem(this);
         if (auto *a = tileAttached(item.get())) {
             a->setTiler(this);
             a->setIndex(index);
         }
-        tileDelegate_->completeCreate();
+        component->completeCreate();
         return { std::move(item), std::move(context) };
     } else {
         qmlWarning(this) << "tile component does not create an item";
@@ -99,6 +127,137 @@ auto Tiler::createTile(int index) -> Tile
     }
 }
 
+/*!
+ * Starts incubating tile item, and returns placeholder tile to be laid out meanwhile.
+ *
+ * The placeholder is replaced by the tile item when the incubation completes.
+ * If no placeholder component is specified, an empty item is used instead.
+ */
+auto Tiler::incubateTile(int index) -> Tile
+{
+    Tile placeholder;
+    if (placeholder_) {
+        placeholder = createComponentTile(placeholder_, index);
+    }
+    if (!placeholder.item) {
+        placeholder.item.reset(new QQuickItem(this));
+    }
+
+    // See qquicksplitview.cpp
+    auto *creationContext = tileDelegate_->creationContext();
+    if (!creationContext)
+        creationContext = qmlContext(this);
+    auto context = std::make_unique<QQmlContext>(creationContext);
+    context->setContextObject(this);
+
+    auto incubator = std::make_unique<TileIncubator>(
+            std::move(context), placeholder.item.get(),
+            [this](TileIncubator *incubator, QObject *object) {
+                initializeIncubatedItem(incubator, object);
+            },
+            [this](TileIncubator *incubator) { finishIncubation(incubator); });
+    tileDelegate_->create(*incubator, incubator->context());
+    if (incubator->isError()) {
+        qmlWarning(this) << incubator->errors();
+        return {};
+    }
+    if (incubator->isReady()) {
+        // Completed synchronously, e.g. nested in another incubation.
+        auto *obj = incubator->object();
+        if (auto item = std::unique_ptr<QQuickItem, ItemDeleter>(qobject_cast<QQuickItem *>(obj))) {
+            if (auto *a = tileAttached(item.get())) {
+                a->setIndex(index);
+            }
+            return { std::move(item), incubator->takeContext() };
+        } else {
+            qmlWarning(this) << "tile component does not create an item";
+            delete obj;
+            return {};
+        }
+    }
+    // The caller should put the placeholder at the index.
+    incubator->setTileSlot(index);
+    placeholder.incubator = incubator.get();
+    incubators_.push_back(std::move(incubator));
+    return placeholder;
+}
+
+void Tiler::initializeIncubatedItem(TileIncubator *incubator, QObject *object)
+{
+    auto *item = qobject_cast<QQuickItem *>(object);
+    if (!item)
+        return;
+    item->setParentItem(this);
+    if (auto *a = tileAttached(item)) {
+        a->setTiler(this);
+        a->setIndex(incubator->tileSlot());
+    }
+}
+
+/// Replaces the placeholder with the incubated item.
+void Tiler::finishIncubation(TileIncubator *incubator)
+{
+    const int index = incubator->tileSlot();
+    if (index < 0)
+        return; // failed within create(), handled by incubateTile()
+
+    auto &tile = tiles_.at(static_cast<size_t>(index));
+    Q_ASSERT(tile.item.get() == incubator->placeholder());
+    if (incubator->isReady()) {
+        auto *obj = incubator->object();
+        if (auto item = std::unique_ptr<QQuickItem, ItemDeleter>(qobject_cast<QQuickItem *>(obj))) {
+            if (auto *a = tileAttached(item.get())) {
+                a->setIndex(index);
+            }
+            tile = { std::move(item), incubator->takeContext() };
+        } else {
+            qmlWarning(this) << "tile component does not create an item";
+            delete obj;
+            tile = {};
+        }
+    } else {
+        qmlWarning(this) << incubator->errors();
+        tile = {};
+    }
+
+    invalidateTileMinimumSize(index);
+    polish();
+    if (std::none_of(incubators_.begin(), incubators_.end(),
+                     [](const auto &i) { return i->isLoading(); })) {
+        emit tilesReady();
+    }
+}
+
+/// Aborts the incubation of the tile item if the given item is its placeholder.
+bool Tiler::cancelIncubation(const QQuickItem *placeholder)
+{
+    const auto p =
+            std::find_if(incubators_.begin(), incubators_.end(), [placeholder](const auto &i) {
+                return i->isLoading() && i->placeholder() == placeholder;
+            });
+    if (p == incubators_.end())
+        return false;
+    incubators_.erase(p);
+    if (std::none_of(incubators_.begin(), incubators_.end(),
+                     [](const auto &i) { return i->isLoading(); })) {
+        emit tilesReady();
+    }
+    return true;
+}
+
+/// Hides the item of the closed tile and keeps it for reuse, or destroys it if !reuseItems.
+void Tiler::poolTile(Tile &&tile)
+{
+    if (!reuseItems_ || !tile.item)
+        return; // destroyed with the tile
+    tile.item->setVisible(false);
+    if (auto *a = tileAttached(tile.item.get())) {
+        a->setIndex(-1);
+        emit a->pooled();
+    }
+    pooledTiles_.push_back(std::move(tile));
+}
+
 void Tiler::setHorizontalHandle(QQmlComponent *handle)
 {
     if (horizontalHandle_ == handle)
@@ -124,13 +283,17 @@ void Tiler::recreateHandles(Qt::Orientation orientation)
     } else {
         verticalHandleHeight_ = 0.0;
     }
-    for (auto &split : splitMap_) {
+    for (size_t i = 0; i < splitMap_.size(); ++i) {
+        auto &split = splitMap_.at(i);
         if (split.orientation != orientation)
             continue;
         for (auto &band : split.bands) {
+            handleItemSplitBands_.erase(band.handleItem.get());
             band = createBand(band.index, band.position, orientation);
         }
+        relinkBands(static_cast<int>(i), 0);
     }
+    invalidateAllMinimumSizes();
     polish();
 }
 
@@ -170,6 +333,33 @@ int Tiler::count() const
     return static_cast<int>(tiles_.size());
 }
 
+void Tiler::setReuseItems(bool reuse)
+{
+    if (reuseItems_ == reuse)
+        return;
+    reuseItems_ = reuse;
+    if (!reuseItems_) {
+        pooledTiles_.clear();
+    }
+    emit reuseItemsChanged();
+}
+
+void Tiler::setAsynchronous(bool asynchronous)
+{
+    if (asynchronous_ == asynchronous)
+        return;
+    asynchronous_ = asynchronous;
+    emit asynchronousChanged();
+}
+
+void Tiler::setPlaceholder(QQmlComponent *placeholder)
+{
+    if (placeholder_ == placeholder)
+        return;
+    placeholder_ = placeholder;
+    emit placeholderChanged();
+}
+
 QQuickItem *Tiler::itemAt(int tileIndex) const
 {
     if (tileIndex < 0 || tileIndex >= static_cast<int>(tiles_.size())) {
@@ -183,30 +373,17 @@ QQuickItem *Tiler::itemAt(int tileIndex) const
 /// Finds indices of (split, band) for the given tile (>= 0) or split (< 0) index.
 std::tuple<int, int> Tiler::findSplitBandByIndex(int index) const
 {
-    for (size_t i = 0; i < splitMap_.size(); ++i) {
-        const auto &split = splitMap_.at(i);
-        const auto p = std::find_if(split.bands.begin(), split.bands.end(),
-                                    [index](const auto &b) { return b.index == index; });
-        if (p == split.bands.end())
-            continue;
-        return { static_cast<int>(i), static_cast<int>(p - split.bands.begin()) };
-    }
-    return { -1, -1 };
+    if (index >= 0)
+        return tileSplitBands_.at(static_cast<size_t>(index));
+    return splitMap_.at(static_cast<size_t>(-index)).parent;
 }
 
 std::tuple<int, int> Tiler::findSplitBandByHandleItem(const QQuickItem *item) const
 {
-    if (!item)
+    const auto p = handleItemSplitBands_.find(item);
+    if (p == handleItemSplitBands_.end())
         return { -1, -1 };
-    for (size_t i = 0; i < splitMap_.size(); ++i) {
-        const auto &split = splitMap_.at(i);
-        const auto p = std::find_if(split.bands.begin(), split.bands.end(),
-                                    [item](const auto &b) { return b.handleItem.get() == item; });
-        if (p == split.bands.end())
-            continue;
-        return { static_cast<int>(i), static_cast<int>(p - split.bands.begin()) };
-    }
-    return { -1, -1 };
+    return p->second;
 }
 
 QSizeF Tiler::minimumSizeByIndex(int index) const
@@ -240,18 +417,8 @@ void Tiler::split(int tileIndex, Qt::Orientation orientation)
 
     // Insert new tile and adjust indices.
     tiles_.insert(tiles_.begin() + tileIndex + 1, createTile(tileIndex + 1));
-    for (size_t i = static_cast<size_t>(tileIndex) + 2; i < tiles_.size(); ++i) {
-        if (auto *a = tileAttached(tiles_.at(i).item.get())) {
-            a->setIndex(static_cast<int>(i));
-        }
-    }
-    for (auto &split : splitMap_) {
-        for (auto &b : split.bands) {
-            if (b.index <= tileIndex)
-                continue;
-            b.index += 1;
-        }
-    }
+    tileSplitBands_.insert(tileSplitBands_.begin() + tileIndex + 1, { -1, -1 });
+    relinkTileIndices(static_cast<size_t>(tileIndex) + 2);
 
     // Allocate band for the new tile.
     const auto [splitIndex, bandIndex] = findSplitBandByIndex(tileIndex);
@@ -265,14 +432,20 @@ void Tiler::split(int tileIndex, Qt::Orientation orientation)
         split.bands.insert(std::next(p),
                            createBand(tileIndex + 1, p->position + size / 2, orientation));
         // p and q may be invalidated.
+        relinkBands(splitIndex, static_cast<size_t>(bandIndex) + 1);
+        invalidateMinimumSize(splitIndex);
     } else {
         std::vector<Band> subBands;
         subBands.push_back(createBand(tileIndex, 0.0, orientation));
         subBands.push_back(createBand(tileIndex + 1, 0.5, orientation));
-        auto &b = split.bands.at(static_cast<size_t>(bandIndex));
-        b.index = -static_cast<int>(splitMap_.size());
-        splitMap_.push_back({ orientation, std::move(subBands), {}, {} });
-        // split and b may be invalidated.
+        const int subSplitIndex =
+                allocateSplit({ orientation, std::move(subBands), {}, {}, {}, { -1, -1 }, true });
+        // split may be invalidated.
+        auto &bands = splitMap_.at(static_cast<size_t>(splitIndex)).bands;
+        bands.at(static_cast<size_t>(bandIndex)).index = -subSplitIndex;
+        relinkBands(splitIndex, static_cast<size_t>(bandIndex));
+        relinkBands(subSplitIndex, 0);
+        invalidateMinimumSize(splitIndex);
     }
 
     polish();
@@ -295,63 +468,216 @@ void Tiler::close(int tileIndex)
     movingSplitBandGrabOffset_ = {};
 
     // Deallocate band of the tile to be removed.
-    unlinkTileByIndex(splitMap_.at(0), tileIndex, 0);
-    cleanTrailingEmptySplits();
+    const auto [splitIndex, bandIndex] = findSplitBandByIndex(tileIndex);
+    invalidateMinimumSize(splitIndex);
+    unlinkBand(splitIndex, bandIndex);
 
-    // Adjust tile indices and remove it.
-    for (size_t i = static_cast<size_t>(tileIndex) + 1; i < tiles_.size(); ++i) {
-        if (auto *a = tileAttached(tiles_.at(i).item.get())) {
-            a->setIndex(static_cast<int>(i - 1));
-        }
-    }
-    for (auto &split : splitMap_) {
-        for (auto &b : split.bands) {
-            if (b.index <= tileIndex)
-                continue;
-            b.index -= 1;
-        }
+    // Remove it and adjust indices.
+    auto &closedTile = tiles_.at(static_cast<size_t>(tileIndex));
+    if (!cancelIncubation(closedTile.item.get())) {
+        poolTile(std::move(closedTile));
     }
     tiles_.erase(tiles_.begin() + tileIndex);
+    tileSplitBands_.erase(tileSplitBands_.begin() + tileIndex);
+    relinkTileIndices(static_cast<size_t>(tileIndex));
+    if (freeSplitIndices_.size() * 2 > splitMap_.size()) {
+        compactSplitMap();
+    }
 
     polish();
     emit countChanged();
 }
 
-bool Tiler::unlinkTileByIndex(Split &split, int index, int depth)
+/*!
+ * Removes the band from the split.
+ *
+ * If only one band remains in a non-root split, the band is moved up to the
+ * parent split, and the emptied split is left unlinked so split indices
+ * wouldn't be invalidated. The emptied split will be reused by allocateSplit()
+ * or removed by compactSplitMap().
+ */
+void Tiler::unlinkBand(int splitIndex, int bandIndex)
 {
-    Q_ASSERT_X(depth < static_cast<int>(splitMap_.size()), __FUNCTION__, "bad recursion detected");
-    for (auto p = split.bands.begin(); p != split.bands.end(); ++p) {
-        if (p->index == index) {
-            Q_ASSERT(split.bands.size() >= 2);
-            if (p == split.bands.begin()) {
-                const auto q = std::next(p);
-                q->position = 0.0;
-                q->handleItem.reset();
-                q->handleContext.reset();
-            }
-            split.bands.erase(p); // iterator gets invalidated.
-            return true;
+    auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
+    Q_ASSERT(split.bands.size() >= 2);
+    const auto p = split.bands.begin() + bandIndex;
+    handleItemSplitBands_.erase(p->handleItem.get());
+    if (p == split.bands.begin()) {
+        const auto q = std::next(p);
+        q->position = 0.0;
+        handleItemSplitBands_.erase(q->handleItem.get());
+        q->handleItem.reset();
+        q->handleContext.reset();
+    }
+    split.bands.erase(p); // iterator gets invalidated.
+    relinkBands(splitIndex, static_cast<size_t>(bandIndex));
+
+    const auto [parentSplitIndex, parentBandIndex] = split.parent;
+    if (split.bands.size() != 1 || parentSplitIndex < 0)
+        return;
+    auto &parentBand = splitMap_.at(static_cast<size_t>(parentSplitIndex))
+                               .bands.at(static_cast<size_t>(parentBandIndex));
+    parentBand.index = split.bands.back().index;
+    split.bands.pop_back(); // the 0th band has no handle item.
+    split.parent = { -1, -1 };
+    freeSplitIndices_.push_back(splitIndex);
+    movedSplits_.erase(std::remove(movedSplits_.begin(), movedSplits_.end(), splitIndex),
+                       movedSplits_.end());
+    relinkBands(parentSplitIndex, static_cast<size_t>(parentBandIndex));
+}
+
+/// Updates the reverse indices of the bands (>= from) of the split.
+void Tiler::relinkBands(int splitIndex, size_t from)
+{
+    auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
+    for (size_t i = from; i < split.bands.size(); ++i) {
+        const auto &band = split.bands.at(i);
+        const std::tuple location(splitIndex, static_cast<int>(i));
+        if (band.index >= 0) {
+            tileSplitBands_.at(static_cast<size_t>(band.index)) = location;
+        } else {
+            splitMap_.at(static_cast<size_t>(-band.index)).parent = location;
+        }
+        if (band.handleItem) {
+            handleItemSplitBands_.insert_or_assign(band.handleItem.get(), location);
+        }
+    }
+}
+
+/// Updates the band, attached and incubator indices of the tiles (>= from) after insertion/removal.
+void Tiler::relinkTileIndices(size_t from)
+{
+    for (size_t i = from; i < tiles_.size(); ++i) {
+        const auto [splitIndex, bandIndex] = tileSplitBands_.at(i);
+        if (splitIndex >= 0) {
+            auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
+            split.bands.at(static_cast<size_t>(bandIndex)).index = static_cast<int>(i);
         }
-        if (p->index >= 0)
+        auto &tile = tiles_.at(i);
+        if (auto *a = tileAttached(tile.item.get())) {
+            a->setIndex(static_cast<int>(i));
+        }
+        if (tile.incubator) {
+            tile.incubator->setTileSlot(static_cast<int>(i));
+        }
+    }
+}
+
+/// Stores the split in an unused slot, and returns its index. The caller must link it.
+int Tiler::allocateSplit(Split &&split)
+{
+    if (freeSplitIndices_.empty()) {
+        splitMap_.push_back(std::move(split));
+        return static_cast<int>(splitMap_.size()) - 1;
+    }
+    const int index = freeSplitIndices_.back();
+    freeSplitIndices_.pop_back();
+    auto &s = splitMap_.at(static_cast<size_t>(index));
+    Q_ASSERT(s.bands.empty());
+    s = std::move(split);
+    return index;
+}
+
+/// Removes unused splits, and renumbers the split indices referring to the live ones.
+void Tiler::compactSplitMap()
+{
+    std::vector<int> newIndices(splitMap_.size(), -1);
+    size_t liveCount = 0;
+    for (size_t i = 0; i < splitMap_.size(); ++i) {
+        if (splitMap_.at(i).bands.empty())
             continue;
-        auto &subSplit = splitMap_.at(static_cast<size_t>(-p->index));
-        if (unlinkTileByIndex(subSplit, index, depth + 1)) {
-            if (subSplit.bands.size() != 1)
-                return true;
-            p->index = subSplit.bands.back().index;
-            subSplit.bands.pop_back(); // leave empty split so split refs wouldn't be invalidated.
-            return true;
+        newIndices.at(i) = static_cast<int>(liveCount);
+        if (liveCount != i) {
+            splitMap_.at(liveCount) = std::move(splitMap_.at(i));
         }
+        ++liveCount;
+    }
+    Q_ASSERT(newIndices.at(0) == 0); // root should be alive
+    splitMap_.resize(liveCount);
+    freeSplitIndices_.clear();
+
+    const auto remap = [&newIndices](int index) {
+        return index >= 0 ? newIndices.at(static_cast<size_t>(index)) : -1;
+    };
+    for (auto &split : splitMap_) {
+        for (auto &b : split.bands) {
+            if (b.index < 0) {
+                b.index = -remap(-b.index);
+            }
+        }
+        std::get<0>(split.parent) = remap(std::get<0>(split.parent));
+    }
+    for (auto &location : tileSplitBands_) {
+        std::get<0>(location) = remap(std::get<0>(location));
+    }
+    for (auto &[item, location] : handleItemSplitBands_) {
+        std::get<0>(location) = remap(std::get<0>(location));
     }
-    return false;
+    for (auto &index : movedSplits_) {
+        index = remap(index);
+    }
+    movedSplits_.erase(std::remove(movedSplits_.begin(), movedSplits_.end(), -1),
+                       movedSplits_.end());
 }
 
-/// Removes empty splits without remapping indices.
-void Tiler::cleanTrailingEmptySplits()
+/*!
+ * Checks if the reverse indices, the free slots and the dirty flags are consistent
+ * with the split tree.
+ *
+ * This is slow and is intended for debugging.
+ */
+bool Tiler::verifySplitMap() const
 {
-    const auto p = std::find_if(splitMap_.rbegin(), splitMap_.rend(),
-                                [](const auto &s) { return !s.bands.empty(); });
-    splitMap_.erase(p.base(), splitMap_.end());
+    if (splitMap_.empty() || splitMap_.at(0).bands.empty()
+        || splitMap_.at(0).parent != std::tuple(-1, -1))
+        return false;
+    if (tileSplitBands_.size() != tiles_.size())
+        return false;
+
+    size_t tileBandCount = 0, handleItemCount = 0, emptySplitCount = 0;
+    for (size_t i = 0; i < splitMap_.size(); ++i) {
+        const auto &split = splitMap_.at(i);
+        if (split.bands.empty()) {
+            if (std::find(freeSplitIndices_.begin(), freeSplitIndices_.end(), static_cast<int>(i))
+                == freeSplitIndices_.end())
+                return false;
+            ++emptySplitCount;
+            continue;
+        }
+        if ((i > 0 && split.bands.size() < 2) || split.bands.front().position != 0.0)
+            return false;
+        for (size_t j = 0; j < split.bands.size(); ++j) {
+            const auto &band = split.bands.at(j);
+            const std::tuple location(static_cast<int>(i), static_cast<int>(j));
+            if (band.index >= 0) {
+                if (tileSplitBands_.at(static_cast<size_t>(band.index)) != location)
+                    return false;
+                ++tileBandCount;
+            } else {
+                const auto &child = splitMap_.at(static_cast<size_t>(-band.index));
+                if (child.parent != location || child.bands.empty())
+                    return false;
+            }
+            if (band.handleItem) {
+                const auto p = handleItemSplitBands_.find(band.handleItem.get());
+                if (p == handleItemSplitBands_.end() || p->second != location)
+                    return false;
+                ++handleItemCount;
+            }
+        }
+        // If a split is dirty, its ancestors should also be dirty.
+        const int parentIndex = std::get<0>(split.parent);
+        if (split.minimumSizeDirty && parentIndex >= 0
+            && !splitMap_.at(static_cast<size_t>(parentIndex)).minimumSizeDirty)
+            return false;
+    }
+    if (tileBandCount != tiles_.size() || handleItemCount != handleItemSplitBands_.size()
+        || emptySplitCount != freeSplitIndices_.size())
+        return false;
+    return std::all_of(movedSplits_.begin(), movedSplits_.end(), [this](int index) {
+        return index >= 0 && index < static_cast<int>(splitMap_.size())
+                && !splitMap_.at(static_cast<size_t>(index)).bands.empty();
+    });
 }
 
 void Tiler::hoverEnterEvent(QHoverEvent *event)
@@ -437,6 +763,9 @@ void Tiler::moveSplitBand(int splitIndex, int bandIndex, const QPointF &itemPos)
 
     const qreal exactPos = ((isHorizontal ? itemPos.x() : itemPos.y()) - boundStartPos) / boundSize;
     targetBand.position = std::clamp(exactPos, minPos, maxPos);
+    if (std::find(movedSplits_.begin(), movedSplits_.end(), splitIndex) == movedSplits_.end()) {
+        movedSplits_.push_back(splitIndex);
+    }
     polish();
 }
 
@@ -448,14 +777,61 @@ void Tiler::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
 
 void Tiler::updatePolish()
 {
+    incubators_.erase(std::remove_if(incubators_.begin(), incubators_.end(),
+                                     [](const auto &i) { return !i->isLoading(); }),
+                      incubators_.end());
+
+    // Structural and minimum size changes mark the root split dirty. Otherwise,
+    // only the splits of the moved bands need to be laid out.
+    const auto &rootSplit = splitMap_.at(0);
+    const bool relayoutAll = rootSplit.minimumSizeDirty || rootSplit.outerRect != itemRect(this);
     accumulateTiles(0, 0);
-    resizeTiles(0, itemRect(this), 0);
+    if (relayoutAll) {
+        resizeTiles(0, itemRect(this), 0);
+    } else {
+        for (const int splitIndex : movedSplits_) {
+            const auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
+            resizeTiles(splitIndex, split.outerRect, 0, true);
+        }
+    }
+    movedSplits_.clear();
+}
+
+/// Marks the minimum size of the split and its ancestors to be accumulated again.
+void Tiler::invalidateMinimumSize(int splitIndex)
+{
+    // If a split is dirty, its ancestors should also be dirty.
+    for (int i = splitIndex; i >= 0;) {
+        auto &split = splitMap_.at(static_cast<size_t>(i));
+        if (split.minimumSizeDirty)
+            break;
+        split.minimumSizeDirty = true;
+        i = std::get<0>(split.parent);
+    }
 }
 
+void Tiler::invalidateTileMinimumSize(int tileIndex)
+{
+    if (tileIndex < 0 || tileIndex >= static_cast<int>(tiles_.size()))
+        return; // pooled or being incubated
+    invalidateMinimumSize(std::get<0>(findSplitBandByIndex(tileIndex)));
+}
+
+/// Marks all splits dirty, e.g. because the handle size changed.
+void Tiler::invalidateAllMinimumSizes()
+{
+    for (auto &split : splitMap_) {
+        split.minimumSizeDirty = true;
+    }
+}
+
+/// Updates the minimum size of the dirty splits recursively.
 void Tiler::accumulateTiles(int splitIndex, int depth)
 {
     Q_ASSERT_X(depth < static_cast<int>(splitMap_.size()), __FUNCTION__, "bad recursion detected");
     auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
+    if (!split.minimumSizeDirty)
+        return;
     qreal totalMinimumWidth = (split.orientation == Qt::Horizontal) ? -horizontalHandleWidth_ : 0.0;
     qreal totalMinimumHeight = (split.orientation != Qt::Horizontal) ? -verticalHandleHeight_ : 0.0;
     for (size_t i = 0; i < split.bands.size(); ++i) {
@@ -473,9 +849,16 @@ void Tiler::accumulateTiles(int splitIndex, int depth)
         }
     }
     split.minimumSize = { totalMinimumWidth, totalMinimumHeight };
+    split.minimumSizeDirty = false;
 }
 
-void Tiler::resizeTiles(int splitIndex, const QRectF &outerRect, int depth)
+/*!
+ * Lays out the bands of the split and their subtrees.
+ *
+ * If changedOnly, the bands of unchanged positions are skipped. The outerRect
+ * should be the cached one in that case.
+ */
+void Tiler::resizeTiles(int splitIndex, const QRectF &outerRect, int depth, bool changedOnly)
 {
     Q_ASSERT_X(depth < static_cast<int>(splitMap_.size()), __FUNCTION__, "bad recursion detected");
     auto &split = splitMap_.at(static_cast<size_t>(splitIndex));
@@ -525,10 +908,14 @@ void Tiler::resizeTiles(int splitIndex, const QRectF &outerRect, int depth)
         itemPositions.at(i) = boundPos;
     }
 
+    const auto &lastItemPositions = split.itemPositions; // may be outdated if !changedOnly
+    Q_ASSERT(!changedOnly || lastItemPositions.size() == itemPositions.size());
     for (size_t i = 0; i < split.bands.size(); ++i) {
         const auto &band = split.bands.at(i);
         const qreal s = itemPositions.at(i);
         const qreal e = itemPositions.at(i + 1);
+        if (changedOnly && s == lastItemPositions.at(i) && e == lastItemPositions.at(i + 1))
+            continue;
         const qreal m = handleSize;
         const auto handleRect = isHorizontal ? QRectF(s, outerRect.y(), m, outerRect.height())
                                              : QRectF(outerRect.x(), s, outerRect.width(), m);
@@ -548,6 +935,7 @@ void Tiler::resizeTiles(int splitIndex, const QRectF &outerRect, int depth)
             resizeTiles(-band.index, contentRect, depth + 1);
         }
     }
+    split.itemPositions = std::move(itemPositions);
 }
 
 void Tiler::ItemDeleter::operator()(QQuickItem *item) const
@@ -598,5 +986,6 @@ void TilerAttached::requestPolish()
 {
     if (!tiler_)
         return;
+    tiler_->invalidateTileMinimumSize(index_);
     tiler_->polish();
 }
@@ -8,8 +8,10 @@
 #include <QSizeF>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
+class TileIncubator;
 class TilerAttached;
 
 class Tiler : public QQuickItem
@@ -21,6 +23,11 @@ class Tiler : public QQuickItem
     Q_PROPERTY(QQmlComponent *verticalHandle READ verticalHandle WRITE setVerticalHandle NOTIFY
                        verticalHandleChanged FINAL)
     Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(bool reuseItems READ reuseItems WRITE setReuseItems NOTIFY reuseItemsChanged FINAL)
+    Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous NOTIFY asynchronousChanged
+                       FINAL)
+    Q_PROPERTY(QQmlComponent *placeholder READ placeholder WRITE setPlaceholder NOTIFY
+                       placeholderChanged FINAL)
     QML_ATTACHED(TilerAttached)
     QML_ELEMENT
 
@@ -42,14 +49,29 @@ public:
     int count() const;
     Q_INVOKABLE QQuickItem *itemAt(int tileIndex) const;
 
+    bool reuseItems() const { return reuseItems_; }
+    void setReuseItems(bool reuse);
+
+    bool asynchronous() const { return asynchronous_; }
+    void setAsynchronous(bool asynchronous);
+
+    QQmlComponent *placeholder() { return placeholder_; }
+    void setPlaceholder(QQmlComponent *placeholder);
+
     Q_INVOKABLE void split(int tileIndex, Qt::Orientation orientation);
     Q_INVOKABLE void close(int tileIndex);
 
+    bool verifySplitMap() const;
+
 signals:
     void delegateChanged();
     void horizontalHandleChanged();
     void verticalHandleChanged();
     void countChanged();
+    void reuseItemsChanged();
+    void asynchronousChanged();
+    void placeholderChanged();
+    void tilesReady();
 
 protected:
     void hoverEnterEvent(QHoverEvent *event) override;
@@ -72,6 +94,7 @@ private:
     {
         std::unique_ptr<QQuickItem, ItemDeleter> item; // may be nullptr
         std::unique_ptr<QQmlContext> context; // may be nullptr if !item
+        TileIncubator *incubator = nullptr; // while item is its placeholder
     };
 
     struct Band
@@ -88,24 +111,43 @@ private:
         std::vector<Band> bands;
         QRectF outerRect; // cache updated by resizeTiles()
         QSizeF minimumSize; // cache updated by accumulateTiles()
+        std::vector<qreal> itemPositions; // cache updated by resizeTiles()
+        std::tuple<int, int> parent; // (split, band) linking to this, or (-1, -1)
+        bool minimumSizeDirty; // set by invalidateMinimumSize() if minimumSize is outdated
     };
 
     void recreateTiles();
     Tile createTile(int index);
+    Tile createComponentTile(QQmlComponent *component, int index);
+    Tile incubateTile(int index);
+    void initializeIncubatedItem(TileIncubator *incubator, QObject *object);
+    void finishIncubation(TileIncubator *incubator);
+    bool cancelIncubation(const QQuickItem *placeholder);
+    void poolTile(Tile &&tile);
     void recreateHandles(Qt::Orientation orientation);
     Band createBand(int index, qreal position, Qt::Orientation orientation);
     std::tuple<int, int> findSplitBandByIndex(int index) const;
     std::tuple<int, int> findSplitBandByHandleItem(const QQuickItem *item) const;
     QSizeF minimumSizeByIndex(int index) const;
-    bool unlinkTileByIndex(Split &split, int index, int depth);
-    void cleanTrailingEmptySplits();
+    void unlinkBand(int splitIndex, int bandIndex);
+    void relinkBands(int splitIndex, size_t from);
+    void relinkTileIndices(size_t from);
+    int allocateSplit(Split &&split);
+    void compactSplitMap();
     void updateHovered(const QPointF &position);
     void moveSplitBand(int splitIndex, int bandIndex, const QPointF &itemPos);
+    void invalidateMinimumSize(int splitIndex);
+    void invalidateTileMinimumSize(int tileIndex);
+    void invalidateAllMinimumSizes();
     void accumulateTiles(int splitIndex, int depth);
-    void resizeTiles(int splitIndex, const QRectF &outerRect, int depth);
+    void resizeTiles(int splitIndex, const QRectF &outerRect, int depth, bool changedOnly = false);
 
     std::vector<Tile> tiles_;
     std::vector<Split> splitMap_;
+    std::vector<int> freeSplitIndices_; // unlinked empty splits in splitMap_
+    // Reverse indices of splitMap_ maintained by relinkBands().
+    std::vector<std::tuple<int, int>> tileSplitBands_; // (split, band) by tile index
+    std::unordered_map<const QQuickItem *, std::tuple<int, int>> handleItemSplitBands_;
     QPointer<QQmlComponent> tileDelegate_ = nullptr;
     QPointer<QQmlComponent> horizontalHandle_ = nullptr;
     QPointer<QQmlComponent> verticalHandle_ = nullptr;
@@ -114,6 +156,14 @@ private:
     int movingSplitIndex_ = -1;
     int movingBandIndex_ = -1;
     QPointF movingSplitBandGrabOffset_;
+    std::vector<int> movedSplits_; // to be laid out by the next polish
+    std::vector<Tile> pooledTiles_; // hidden tile items to be reused if reuseItems_
+    bool reuseItems_ = false;
+    QPointer<QQmlComponent> placeholder_ = nullptr;
+    std::vector<std::unique_ptr<TileIncubator>> incubators_; // finished ones are removed on polish
+    bool asynchronous_ = false;
+
+    friend class TilerAttached; // for invalidateTileMinimumSize()
 };
 
 class TilerAttached : public QObject
@@ -146,6 +196,8 @@ signals:
     void indexChanged();
     void minimumWidthChanged();
     void minimumHeightChanged();
+    void pooled();
+    void reused();
 
 private:
     void requestPolish();
@@ -0,0 +1,923 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "flextilegeometry.h"
+#include "testutil.h"
+
+namespace {
+constexpr QRectF unitRect { 0.0, 0.0, 1.0, 1.0 };
+// Normalized coordinates are rounded to the fixed-point units.
+constexpr qreal coordEpsilon = FlexTileGeometry::toNorm(1);
+
+/// Byte offsets of the snapshot sections. See flextilegeometry.cpp for the format.
+struct SnapshotOffsets
+{
+    size_t rects;
+    size_t xyLineCount;
+    size_t xyKeys;
+    size_t xyOffsets;
+    size_t xyVertices; // 16 bytes per vertex: pos, handleEnd, tileIndex, primary
+};
+
+constexpr size_t padTo8(size_t size)
+{
+    return (size + 7) / 8 * 8;
+}
+
+template<typename T>
+T readAt(const QByteArray &data, size_t offset)
+{
+    T value;
+    std::memcpy(&value, data.constData() + offset, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void writeAt(QByteArray &data, size_t offset, T value)
+{
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+SnapshotOffsets snapshotOffsetsOf(const QByteArray &data)
+{
+    const auto tileCount = static_cast<size_t>(readAt<quint64>(data, 16));
+    SnapshotOffsets o;
+    o.rects = 24;
+    o.xyLineCount = o.rects + 16 * tileCount + padTo8(tileCount);
+    o.xyKeys = o.xyLineCount + 16;
+    const auto lineCount = static_cast<size_t>(readAt<quint64>(data, o.xyLineCount));
+    o.xyOffsets = o.xyKeys + padTo8(4 * lineCount);
+    o.xyVertices = o.xyOffsets + 8 * (lineCount + 1);
+    return o;
+}
+
+void moveBorder(FlexTileGeometry &geometry, size_t index, Qt::Orientations orientations,
+                const QPointF &normPos, const QSizeF &handleSize, const QSizeF &snapSize = {})
+{
+    geometry.startMoving(index, orientations, false, unitRect, handleSize);
+    geometry.moveTo(normPos, snapSize);
+    geometry.resetMovingState();
+}
+}
+
+TEST(FlexTileGeometryTest, Initial)
+{
+    FlexTileGeometry geometry;
+    ASSERT_EQ(geometry.count(), 1);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, SplitH2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x0);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, 1.0);
+    EXPECT_NEAR(geometry.tileRectAt(1).x0, 0.5, coordEpsilon);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(1).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(1).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, SplitV2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(1).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_EQ(geometry.tileRectAt(1).y1, 1.0);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.5, coordEpsilon);
+}
+
+TEST(FlexTileGeometryTest, Split3x3)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 2, { 0.1, 0.1 });
+    geometry.split(0, Qt::Vertical, 2, { 0.1, 0.1 });
+    geometry.split(3, Qt::Vertical, 2, { 0.1, 0.1 });
+    geometry.split(6, Qt::Vertical, 2, { 0.1, 0.1 });
+    ASSERT_EQ(geometry.count(), 9);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(1).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(2).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(3).x0);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, geometry.tileRectAt(4).x0);
+    EXPECT_EQ(geometry.tileRectAt(2).x1, geometry.tileRectAt(5).x0);
+    EXPECT_EQ(geometry.tileRectAt(3).x1, geometry.tileRectAt(6).x0);
+    EXPECT_EQ(geometry.tileRectAt(4).x1, geometry.tileRectAt(7).x0);
+    EXPECT_EQ(geometry.tileRectAt(5).x1, geometry.tileRectAt(8).x0);
+    EXPECT_EQ(geometry.tileRectAt(6).x1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(7).x1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(8).x1, 1.0);
+    EXPECT_NEAR(geometry.tileRectAt(3).x0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(4).x0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(5).x0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(6).x0, 2.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(7).x0, 2.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(8).x0, 2.0 / 3.0, coordEpsilon);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(3).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(6).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_EQ(geometry.tileRectAt(3).y1, geometry.tileRectAt(4).y0);
+    EXPECT_EQ(geometry.tileRectAt(6).y1, geometry.tileRectAt(7).y0);
+    EXPECT_EQ(geometry.tileRectAt(1).y1, geometry.tileRectAt(2).y0);
+    EXPECT_EQ(geometry.tileRectAt(4).y1, geometry.tileRectAt(5).y0);
+    EXPECT_EQ(geometry.tileRectAt(7).y1, geometry.tileRectAt(8).y0);
+    EXPECT_EQ(geometry.tileRectAt(2).y1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(5).y1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(8).y1, 1.0);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(4).y0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(7).y0, 1.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).y0, 2.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(5).y0, 2.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(8).y0, 2.0 / 3.0, coordEpsilon);
+}
+
+TEST(FlexTileGeometryTest, Close1)
+{
+    FlexTileGeometry geometry;
+    ASSERT_EQ(geometry.count(), 1);
+
+    const int collapsedToIndex = geometry.close(0);
+    ASSERT_EQ(geometry.count(), 1);
+    EXPECT_EQ(collapsedToIndex, -1);
+}
+
+TEST(FlexTileGeometryTest, Close2ToLeft)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    const int collapsedToIndex = geometry.close(1);
+    ASSERT_EQ(geometry.count(), 1);
+    EXPECT_EQ(collapsedToIndex, 0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, Close2ToRight)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    const int collapsedToIndex = geometry.close(0);
+    ASSERT_EQ(geometry.count(), 1);
+    EXPECT_EQ(collapsedToIndex, 0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, Close2ToTop)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    const int collapsedToIndex = geometry.close(1);
+    ASSERT_EQ(geometry.count(), 1);
+    EXPECT_EQ(collapsedToIndex, 0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, Close2ToBottom)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    const int collapsedToIndex = geometry.close(0);
+    ASSERT_EQ(geometry.count(), 1);
+    EXPECT_EQ(collapsedToIndex, 0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, MoveH2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    geometry.startMoving(1, Qt::Horizontal, false, unitRect, {});
+    EXPECT_TRUE(geometry.isMoving());
+
+    geometry.moveTo({ 0.2, 0.0 }, {});
+    EXPECT_TRUE(geometry.isMoving());
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.2, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).x0, 0.2, coordEpsilon);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+
+    geometry.moveTo({ 0.7, 0.0 }, {});
+    geometry.resetMovingState();
+    EXPECT_FALSE(geometry.isMoving());
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.7, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).x0, 0.7, coordEpsilon);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, MoveV2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    geometry.startMoving(1, Qt::Vertical, false, unitRect, {});
+    EXPECT_TRUE(geometry.isMoving());
+
+    geometry.moveTo({ 0.0, 0.3 }, {});
+    EXPECT_TRUE(geometry.isMoving());
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.3, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.3, coordEpsilon);
+    EXPECT_EQ(geometry.tileRectAt(1).y1, 1.0);
+
+    geometry.moveTo({ 0.0, 0.8 }, {});
+    geometry.resetMovingState();
+    EXPECT_FALSE(geometry.isMoving());
+
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x0, 0.0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, 1.0);
+
+    EXPECT_EQ(geometry.tileRectAt(0).y0, 0.0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.8, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.8, coordEpsilon);
+    EXPECT_EQ(geometry.tileRectAt(1).y1, 1.0);
+}
+
+TEST(FlexTileGeometryTest, MoveH2Clamped)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    moveBorder(geometry, 1, Qt::Horizontal, { 0.0, 0.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.1, 0.00001);
+    EXPECT_NEAR(geometry.tileRectAt(1).x0, 0.1, 0.00001);
+
+    moveBorder(geometry, 1, Qt::Horizontal, { 1.0, 1.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.9, 0.00001);
+    EXPECT_NEAR(geometry.tileRectAt(1).x0, 0.9, 0.00001);
+}
+
+TEST(FlexTileGeometryTest, MoveV2Clamped)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    moveBorder(geometry, 1, Qt::Vertical, { 0.0, 0.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.1, 0.00001);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.1, 0.00001);
+
+    moveBorder(geometry, 1, Qt::Vertical, { 1.0, 1.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.9, 0.00001);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.9, 0.00001);
+}
+
+TEST(FlexTileGeometryTest, MoveH2Epsilon)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    moveBorder(geometry, 1, Qt::Horizontal, { 0.0, 0.0 }, { 0.0, 0.0 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x0);
+    EXPECT_LT(geometry.tileRectAt(0).x0, geometry.tileRectAt(0).x1);
+    EXPECT_LT(geometry.tileRectAt(1).x0, geometry.tileRectAt(1).x1);
+
+    moveBorder(geometry, 1, Qt::Horizontal, { 1.0, 1.0 }, { 0.0, 0.0 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x0);
+    EXPECT_LT(geometry.tileRectAt(0).x0, geometry.tileRectAt(0).x1);
+    EXPECT_LT(geometry.tileRectAt(1).x0, geometry.tileRectAt(1).x1);
+}
+
+TEST(FlexTileGeometryTest, MoveV2Epsilon)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+
+    moveBorder(geometry, 1, Qt::Vertical, { 0.0, 0.0 }, { 0.0, 0.0 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_LT(geometry.tileRectAt(0).y0, geometry.tileRectAt(0).y1);
+    EXPECT_LT(geometry.tileRectAt(1).y0, geometry.tileRectAt(1).y1);
+
+    moveBorder(geometry, 1, Qt::Vertical, { 1.0, 1.0 }, { 0.0, 0.0 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_LT(geometry.tileRectAt(0).y0, geometry.tileRectAt(0).y1);
+    EXPECT_LT(geometry.tileRectAt(1).y0, geometry.tileRectAt(1).y1);
+}
+
+TEST(FlexTileGeometryTest, MoveHV2x2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, { 0.1, 0.1 });
+    geometry.split(0, Qt::Vertical, 1, { 0.1, 0.1 });
+    geometry.split(2, Qt::Vertical, 1, { 0.1, 0.1 });
+    ASSERT_EQ(geometry.count(), 4);
+
+    // All borders are isolated at this moment.
+    moveBorder(geometry, 3, Qt::Horizontal, { 0.4, 0.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(2).x0);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, geometry.tileRectAt(3).x0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.5, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).x1, 0.4, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).x0, 0.5, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(3).x0, 0.4, coordEpsilon);
+
+    // Vertical border should get unisolated.
+    moveBorder(geometry, 1, Qt::Vertical, { 0.0, 0.6 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_EQ(geometry.tileRectAt(2).y1, geometry.tileRectAt(3).y0);
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(2).y1);
+    EXPECT_EQ(geometry.tileRectAt(1).y0, geometry.tileRectAt(3).y0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.6, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.6, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).y1, 0.6, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(3).y0, 0.6, coordEpsilon);
+}
+
+TEST(FlexTileGeometryTest, MoveVH2x2)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, { 0.1, 0.1 });
+    geometry.split(0, Qt::Vertical, 1, { 0.1, 0.1 });
+    geometry.split(2, Qt::Vertical, 1, { 0.1, 0.1 });
+    ASSERT_EQ(geometry.count(), 4);
+
+    // All borders are isolated at this moment.
+    moveBorder(geometry, 1, Qt::Vertical, { 0.0, 0.3 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).y1, geometry.tileRectAt(1).y0);
+    EXPECT_EQ(geometry.tileRectAt(2).y1, geometry.tileRectAt(3).y0);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.3, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.3, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).y1, 0.5, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(3).y0, 0.5, coordEpsilon);
+
+    // Horizontal border should get unisolated.
+    moveBorder(geometry, 2, Qt::Horizontal, { 0.8, 0.0 }, { 0.1, 0.1 });
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(2).x0);
+    EXPECT_EQ(geometry.tileRectAt(1).x1, geometry.tileRectAt(3).x0);
+    EXPECT_EQ(geometry.tileRectAt(0).x1, geometry.tileRectAt(1).x1);
+    EXPECT_EQ(geometry.tileRectAt(2).x0, geometry.tileRectAt(3).x0);
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.8, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(1).x1, 0.8, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).x0, 0.8, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(3).x0, 0.8, coordEpsilon);
+}
+
+TEST(FlexTileGeometryTest, MoveSnapsToPreMoveLines)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    geometry.split(0, Qt::Vertical, 1, {});
+    geometry.split(2, Qt::Vertical, 2, {});
+    ASSERT_EQ(geometry.count(), 5);
+
+    geometry.startMoving(1, Qt::Vertical, false, unitRect, {});
+    geometry.moveTo({ 0.0, 0.36 }, { 0.05, 0.05 });
+    EXPECT_EQ(geometry.tileRectAt(1).y0, geometry.tileRectAt(3).y0);
+
+    // The original line at 0.5 should be snappable even though it has been moved.
+    geometry.moveTo({ 0.0, 0.52 }, { 0.05, 0.05 });
+    EXPECT_NEAR(geometry.tileRectAt(1).y0, 0.5, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(0).y1, 0.5, coordEpsilon);
+
+    geometry.moveTo({ 0.0, 0.7 }, { 0.05, 0.05 });
+    EXPECT_EQ(geometry.tileRectAt(1).y0, geometry.tileRectAt(4).y0);
+    geometry.resetMovingState();
+}
+
+TEST(FlexTileGeometryTest, MoveClampedByMinimumSize)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 2);
+    geometry.setMinimumSize(0, { 30.0, 0.0 });
+    geometry.setMinimumSize(1, { 20.0, 0.0 });
+
+    const QRectF outerPixelRect(0.0, 0.0, 100.0, 100.0);
+    geometry.startMoving(1, Qt::Horizontal, false, outerPixelRect, { 0.0, 0.0 });
+    geometry.moveTo({ 0.1, 0.0 }, {});
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.3, coordEpsilon);
+    geometry.moveTo({ 0.9, 0.0 }, {});
+    EXPECT_NEAR(geometry.tileRectAt(0).x1, 0.8, coordEpsilon);
+    geometry.resetMovingState();
+}
+
+TEST(FlexTileGeometryTest, MoveJoinsSplitLineExactly)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Vertical, 1, {});
+    geometry.split(0, Qt::Horizontal, 2, {});
+    geometry.split(3, Qt::Horizontal, 1, {});
+    ASSERT_EQ(geometry.count(), 5);
+
+    // No snapping. The fixed-point position should still match the split line.
+    moveBorder(geometry, 4, Qt::Horizontal, { 2.0 / 3.0, 0.0 }, {});
+    EXPECT_EQ(geometry.tileRectAt(4).x0, geometry.tileRectAt(2).x0);
+    moveBorder(geometry, 4, Qt::Horizontal, { 1.0 / 3.0, 0.0 }, {});
+    EXPECT_EQ(geometry.tileRectAt(4).x0, geometry.tileRectAt(1).x0);
+    EXPECT_TRUE(geometry.verifyVerticesMap());
+}
+
+TEST(FlexTileGeometryTest, LoadTiles)
+{
+    FlexTileGeometry source;
+    source.split(0, Qt::Horizontal, 2, {});
+    source.split(1, Qt::Vertical, 1, {});
+    moveBorder(source, 2, Qt::Vertical, { 0.5, 0.3 }, {});
+    const auto rects = source.tileRects();
+    ASSERT_TRUE(FlexTileGeometry::isValidLayout(rects));
+
+    FlexTileGeometry geometry;
+    geometry.loadTiles(rects);
+    ASSERT_EQ(geometry.count(), 4);
+    for (size_t i = 0; i < rects.size(); ++i) {
+        EXPECT_EQ(geometry.tileRectAt(i).x0, rects.at(i).x0);
+        EXPECT_EQ(geometry.tileRectAt(i).y0, rects.at(i).y0);
+        EXPECT_EQ(geometry.tileRectAt(i).x1, rects.at(i).x1);
+        EXPECT_EQ(geometry.tileRectAt(i).y1, rects.at(i).y1);
+    }
+    EXPECT_TRUE(geometry.verifyVerticesMap());
+    EXPECT_EQ(geometry.close(2), 1);
+    EXPECT_TRUE(geometry.verifyVerticesMap());
+}
+
+TEST(FlexTileGeometryTest, IsValidLayout)
+{
+    EXPECT_TRUE(FlexTileGeometry::isValidLayout({ { 0.0, 0.0, 1.0, 1.0 } }));
+    EXPECT_TRUE(FlexTileGeometry::isValidLayout(
+            { { 0.0, 0.0, 0.5, 1.0 }, { 0.5, 0.0, 1.0, 0.5 }, { 0.5, 0.5, 1.0, 1.0 } }));
+
+    EXPECT_FALSE(FlexTileGeometry::isValidLayout({}));
+    // gap
+    EXPECT_FALSE(FlexTileGeometry::isValidLayout({ { 0.0, 0.0, 0.5, 1.0 } }));
+    // overlap compensating gap
+    EXPECT_FALSE(FlexTileGeometry::isValidLayout(
+            { { 0.0, 0.0, 0.5, 1.0 }, { 0.25, 0.0, 0.75, 0.5 }, { 0.5, 0.5, 1.0, 1.0 } }));
+    // empty and out of range
+    EXPECT_FALSE(FlexTileGeometry::isValidLayout(
+            { { 0.0, 0.0, 1.0, 1.0 }, { 0.5, 0.5, 0.5, 0.5 } }));
+    EXPECT_FALSE(FlexTileGeometry::isValidLayout(
+            { { -0.5, 0.0, 0.5, 1.0 }, { 0.5, 0.0, 1.0, 1.0 } }));
+}
+
+TEST(FlexTileGeometryTest, LoadSnapshot)
+{
+    FlexTileGeometry source;
+    source.split(0, Qt::Horizontal, 2, {});
+    source.split(1, Qt::Vertical, 1, {});
+    moveBorder(source, 2, Qt::Vertical, { 0.5, 0.3 }, {});
+    const auto data = source.saveSnapshot();
+
+    FlexTileGeometry geometry;
+    ASSERT_TRUE(geometry.loadSnapshot(data.constData(), static_cast<size_t>(data.size())));
+    ASSERT_EQ(geometry.count(), 4);
+    for (size_t i = 0; i < geometry.count(); ++i) {
+        EXPECT_EQ(geometry.tileRectAt(i).x0, source.tileRectAt(i).x0);
+        EXPECT_EQ(geometry.tileRectAt(i).y0, source.tileRectAt(i).y0);
+        EXPECT_EQ(geometry.tileRectAt(i).x1, source.tileRectAt(i).x1);
+        EXPECT_EQ(geometry.tileRectAt(i).y1, source.tileRectAt(i).y1);
+    }
+    EXPECT_TRUE(geometry.verifyVerticesMap());
+    EXPECT_EQ(geometry.close(2), 1);
+    EXPECT_TRUE(geometry.verifyVerticesMap());
+
+    FlexTileGeometry other;
+    EXPECT_FALSE(other.loadSnapshot(data.constData(), static_cast<size_t>(data.size()) - 1));
+    EXPECT_FALSE(other.loadSnapshot(data.constData(), 0));
+    EXPECT_EQ(other.count(), 1);
+
+    // Snapshots of any valid layout should pass the consistency check.
+    std::mt19937 rng(5);
+    FlexTileGeometry random;
+    for (int n = 0; n < 40; ++n) {
+        const size_t index = rng() % random.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        random.split(index, orientation, 1 + rng() % 2, { 0.05, 0.05 });
+        const auto randomData = random.saveSnapshot();
+        ASSERT_TRUE(other.loadSnapshot(randomData.constData(),
+                                       static_cast<size_t>(randomData.size())))
+                << n;
+    }
+}
+
+TEST(FlexTileGeometryTest, LoadSnapshotRejectsInconsistentData)
+{
+    FlexTileGeometry source;
+    source.split(0, Qt::Horizontal, 2, {});
+    source.split(1, Qt::Vertical, 1, {});
+    const auto data = source.saveSnapshot();
+    const auto o = snapshotOffsetsOf(data);
+    const auto load = [](const QByteArray &data) {
+        FlexTileGeometry geometry;
+        const bool ok = geometry.loadSnapshot(data.constData(), static_cast<size_t>(data.size()));
+        EXPECT_EQ(geometry.count(), ok ? 4u : 1u);
+        return ok;
+    };
+    ASSERT_TRUE(load(data));
+
+    {
+        // Tile 1 overlaps tile 0.
+        auto d = data;
+        writeAt<qint32>(d, o.rects + 16, 0);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Maps of no lines.
+        auto d = QByteArray(data.constData(), static_cast<qsizetype>(o.xyLineCount));
+        const quint64 zeros[4] = {};
+        d.append(reinterpret_cast<const char *>(zeros), sizeof(zeros));
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // First line doesn't start at 0.
+        auto d = data;
+        writeAt<qint32>(d, o.xyKeys, 1);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Terminal line isn't at 1.
+        auto d = data;
+        const auto lineCount = readAt<quint64>(d, o.xyLineCount);
+        writeAt<qint32>(d, o.xyKeys + 4 * (lineCount - 1), FlexTileGeometry::coordOne - 1);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Offset out of range.
+        auto d = data;
+        writeAt<quint64>(d, o.xyOffsets + 8, quint64(1) << 40);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Vertex refers to a tile of different edges.
+        auto d = data;
+        writeAt<qint32>(d, o.xyVertices + 8, 3);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Vertex position doesn't match the tile.
+        auto d = data;
+        writeAt<qint32>(d, o.xyVertices, 1);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Handle spans to a position where no vertex exists.
+        auto d = data;
+        writeAt<qint32>(d, o.xyVertices + 4, 12345);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Missing terminator.
+        auto d = data;
+        writeAt<qint32>(d, o.xyVertices + 16 + 8, 0);
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Collapsible flag of tile 0 is flipped.
+        auto d = data;
+        const size_t offset = o.rects + 16 * 4;
+        writeAt<quint8>(d, offset, !readAt<quint8>(d, offset));
+        EXPECT_FALSE(load(d));
+    }
+    {
+        // Handle of tile 1 ends at the next vertex instead of the end of the line. The
+        // line at x = 1/3 has tile 1 at y = 0, tile 2 at y = 1/2, and the terminator.
+        auto d = data;
+        const size_t v1 = o.xyVertices + 16 * 2;
+        const size_t v2 = o.xyVertices + 16 * 3;
+        ASSERT_EQ(readAt<qint32>(d, v1 + 8), 1);
+        ASSERT_EQ(readAt<qint32>(d, v1 + 4), FlexTileGeometry::coordOne);
+        ASSERT_EQ(readAt<qint32>(d, v2 + 8), 2);
+        writeAt<qint32>(d, v1 + 4, readAt<qint32>(d, v2));
+        EXPECT_FALSE(load(d));
+    }
+}
+
+TEST(FlexTileGeometryTest, VerticesMapUpdate)
+{
+    FlexTileGeometry geometry;
+    std::mt19937 rng(1);
+    for (int n = 0; n < 500; ++n) {
+        const size_t index = rng() % geometry.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        switch (rng() % 4) {
+        case 0:
+            if (geometry.count() < 50) {
+                geometry.split(index, orientation, 1 + rng() % 3, { 0.05, 0.05 });
+            }
+            break;
+        case 1:
+            geometry.close(index);
+            break;
+        default:
+            geometry.startMoving(index, orientation, rng() % 2 == 0, unitRect, { 0.01, 0.01 });
+            for (int i = 0; i < 3 && geometry.isMoving(); ++i) {
+                const QPointF pos(static_cast<qreal>(rng() % 100) / 100.0,
+                                  static_cast<qreal>(rng() % 100) / 100.0);
+                geometry.moveTo(pos, { 0.02, 0.02 });
+                ASSERT_TRUE(geometry.verifyVerticesMap());
+            }
+            geometry.resetMovingState();
+            break;
+        }
+        ASSERT_TRUE(geometry.verifyVerticesMap());
+    }
+}
+
+TEST(FlexTileGeometryTest, AssignTilesRebuildsVerticesMaps)
+{
+    FlexTileGeometry geometry;
+    std::mt19937 rng(7);
+    for (int n = 0; n < 30; ++n) {
+        const size_t index = rng() % geometry.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        geometry.split(index, orientation, 1 + rng() % 3, {});
+    }
+    geometry.setMinimumSize(3, { 300.0, 200.0 });
+    const QRectF outerRect(0.0, 0.0, 1200.0, 800.0);
+    const QSizeF handleSize(4.0, 4.0);
+    std::vector<FlexTileGeometry::PixelRects> expectedRects;
+    geometry.calculatePixelRects(outerRect, handleSize, expectedRects);
+
+    // The old tiles and maps should be discarded.
+    FlexTileGeometry copy;
+    copy.split(0, Qt::Vertical, 3, {});
+    copy.startMoving(1, Qt::Vertical, false, outerRect, handleSize);
+    copy.assignTiles(geometry);
+    EXPECT_FALSE(copy.isMoving());
+    EXPECT_EQ(copy.revision(), geometry.revision());
+    EXPECT_EQ(copy.indexRevision(), geometry.indexRevision());
+    ASSERT_EQ(copy.count(), geometry.count());
+    EXPECT_EQ(copy.minimumSizeAt(3), QSizeF(300.0, 200.0));
+
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    copy.calculatePixelRects(outerRect, handleSize, pixelRects);
+    EXPECT_TRUE(copy.verifyVerticesMap());
+    ASSERT_EQ(pixelRects.size(), expectedRects.size());
+    for (size_t i = 0; i < pixelRects.size(); ++i) {
+        EXPECT_EQ(pixelRects.at(i).item, expectedRects.at(i).item) << i;
+        EXPECT_EQ(pixelRects.at(i).horizontalHandle, expectedRects.at(i).horizontalHandle) << i;
+        EXPECT_EQ(pixelRects.at(i).verticalHandle, expectedRects.at(i).verticalHandle) << i;
+        EXPECT_EQ(copy.isCollapsible(i), geometry.isCollapsible(i)) << i;
+    }
+}
+
+TEST(FlexTileGeometryTest, HitTestMatchesPixelRects)
+{
+    FlexTileGeometry geometry;
+    std::mt19937 rng(2);
+    for (int n = 0; n < 30; ++n) {
+        const size_t index = rng() % geometry.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        geometry.split(index, orientation, 1 + rng() % 2, { 0.05, 0.05 });
+    }
+
+    const QRectF outerRect(-4.0, -3.0, 204.0, 103.0);
+    const QSizeF handleSize(4.0, 3.0);
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    geometry.calculatePixelRects(outerRect, handleSize, pixelRects);
+
+    for (qreal y = -3.0; y < 100.0; y += 1.0) {
+        for (qreal x = -4.0; x < 200.0; x += 1.0) {
+            const QPointF pos(x + 0.5, y + 0.5);
+            // Handles of close lines may overlap.
+            std::vector<std::tuple<int, Qt::Orientations>> expectedHandles;
+            for (size_t i = 0; i < pixelRects.size(); ++i) {
+                const auto &rects = pixelRects.at(i);
+                if (rects.horizontalHandle && rects.horizontalHandle->contains(pos)) {
+                    expectedHandles.emplace_back(static_cast<int>(i), Qt::Horizontal);
+                }
+                if (rects.verticalHandle && rects.verticalHandle->contains(pos)) {
+                    expectedHandles.emplace_back(static_cast<int>(i), Qt::Vertical);
+                }
+            }
+            const auto handle = geometry.handleAt(pos, outerRect, handleSize);
+            if (expectedHandles.empty()) {
+                EXPECT_EQ(std::get<0>(handle), -1) << x << "," << y;
+            } else {
+                EXPECT_NE(std::find(expectedHandles.begin(), expectedHandles.end(), handle),
+                          expectedHandles.end())
+                        << x << "," << y;
+            }
+
+            // Tile area includes the left and top handles.
+            const int tile = geometry.tileAt(pos, outerRect, handleSize);
+            ASSERT_GE(tile, 0) << x << "," << y;
+            const auto &item = pixelRects.at(static_cast<size_t>(tile)).item;
+            EXPECT_TRUE(item.adjusted(-handleSize.width(), -handleSize.height(), 0.0, 0.0)
+                                .contains(pos))
+                    << x << "," << y;
+        }
+    }
+    EXPECT_EQ(geometry.tileAt({ 200.5, 0.0 }, outerRect, handleSize), -1);
+    EXPECT_EQ(geometry.tileAt({ -4.5, 0.0 }, outerRect, handleSize), -1);
+}
+
+TEST(FlexTileGeometryTest, HitTestDoesNotAllocateAfterLayout)
+{
+    FlexTileGeometry source;
+    std::mt19937 rng(6);
+    for (int n = 0; n < 30; ++n) {
+        const size_t index = rng() % source.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        source.split(index, orientation, 1 + rng() % 2, {});
+    }
+
+    // Laid out from a copy, which is then moved, as FlexTiler keeps the applied layout.
+    FlexTileGeometry copy;
+    copy.assignTiles(source);
+    const QRectF outerRect(-4.0, -3.0, 204.0, 103.0);
+    const QSizeF handleSize(4.0, 3.0);
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    copy.calculatePixelRects(outerRect, handleSize, pixelRects);
+    const FlexTileGeometry geometry = std::move(copy);
+
+    // The line pixels cached by calculatePixelRects() should be looked up.
+    int tileHits = 0, handleHits = 0;
+    const size_t start = allocationCount();
+    for (qreal y = -3.0; y < 100.0; y += 2.0) {
+        for (qreal x = -4.0; x < 200.0; x += 2.0) {
+            const QPointF pos(x + 0.5, y + 0.5);
+            tileHits += geometry.tileAt(pos, outerRect, handleSize) >= 0;
+            handleHits += std::get<0>(geometry.handleAt(pos, outerRect, handleSize)) >= 0;
+        }
+    }
+    EXPECT_EQ(allocationCount() - start, 0u) << "allocations by hit tests";
+    EXPECT_EQ(tileHits, 102 * 52);
+    EXPECT_GT(handleHits, 0);
+}
+
+TEST(FlexTileGeometryTest, PixelRectsMatchTileRects)
+{
+    FlexTileGeometry geometry;
+    std::mt19937 rng(3);
+    for (int n = 0; n < 50; ++n) {
+        const size_t index = rng() % geometry.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        geometry.split(index, orientation, 1 + rng() % 3, {});
+    }
+
+    // Odd sizes so some of the edges fall on half pixels. Large enough that no tile
+    // is squeezed below the handle size.
+    const QRectF outerRect(-5.0, 7.0, 3333.0, 1711.0);
+    const QSizeF handleSize(2.0, 3.0);
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    geometry.calculatePixelRects(outerRect, handleSize, pixelRects);
+    ASSERT_EQ(pixelRects.size(), geometry.count());
+    for (size_t i = 0; i < geometry.count(); ++i) {
+        const auto &r = geometry.tileRectAt(i);
+        const auto p0 = FlexTileGeometry::mapToPixel({ r.x0, r.y0 }, outerRect);
+        const auto p1 = FlexTileGeometry::mapToPixel({ r.x1, r.y1 }, outerRect);
+        EXPECT_EQ(pixelRects.at(i).item, QRectF(p0 + QPointF(2.0, 3.0), p1)) << i;
+    }
+}
+
+TEST(FlexTileGeometryTest, PixelRectsFitMinimumSize)
+{
+    FlexTileGeometry geometry;
+    geometry.split(0, Qt::Horizontal, 2, {});
+    geometry.split(1, Qt::Vertical, 1, {});
+    ASSERT_EQ(geometry.count(), 4);
+    // 0 | 1 | 3
+    //   |---|
+    //   | 2 |
+    geometry.setMinimumSize(1, { 80.0, 70.0 });
+
+    const QRectF outerRect(-4.0, 0.0, 154.0, 100.0);
+    const QSizeF handleSize(4.0, 0.0);
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    geometry.calculatePixelRects(outerRect, handleSize, pixelRects);
+    EXPECT_EQ(pixelRects.at(0).item, QRectF(0.0, 0.0, 47.0, 100.0));
+    EXPECT_EQ(pixelRects.at(1).item, QRectF(51.0, 0.0, 80.0, 70.0));
+    EXPECT_EQ(pixelRects.at(2).item, QRectF(51.0, 70.0, 80.0, 30.0));
+    EXPECT_EQ(pixelRects.at(3).item, QRectF(135.0, 0.0, 15.0, 100.0));
+    ASSERT_TRUE(pixelRects.at(3).horizontalHandle);
+    EXPECT_EQ(*pixelRects.at(3).horizontalHandle, QRectF(131.0, 0.0, 4.0, 100.0));
+    EXPECT_EQ(geometry.tileAt({ 120.0, 50.0 }, outerRect, handleSize), 1);
+    EXPECT_EQ(std::get<0>(geometry.handleAt({ 132.0, 50.0 }, outerRect, handleSize)), 3);
+
+    // The normalized layout is kept.
+    EXPECT_NEAR(geometry.tileRectAt(3).x0, 2.0 / 3.0, coordEpsilon);
+    EXPECT_NEAR(geometry.tileRectAt(2).y0, 0.5, coordEpsilon);
+
+    // The last tile is pushed out and then pulled back, so the first tile is squeezed.
+    geometry.setMinimumSize(3, { 40.0, 0.0 });
+    geometry.calculatePixelRects(outerRect, handleSize, pixelRects);
+    EXPECT_EQ(pixelRects.at(0).item, QRectF(0.0, 0.0, 22.0, 100.0));
+    EXPECT_EQ(pixelRects.at(1).item, QRectF(26.0, 0.0, 80.0, 70.0));
+    EXPECT_EQ(pixelRects.at(3).item, QRectF(110.0, 0.0, 40.0, 100.0));
+
+    // Without minimum sizes, the handles still have to fit.
+    geometry.setMinimumSize(1, { 0.0, 0.0 });
+    geometry.setMinimumSize(3, { 0.0, 0.0 });
+    const QRectF narrowOuterRect(-4.0, 0.0, 10.0, 100.0);
+    geometry.calculatePixelRects(narrowOuterRect, handleSize, pixelRects);
+    EXPECT_EQ(pixelRects.at(1).item, QRectF(2.0, 0.0, 0.0, 50.0));
+    EXPECT_EQ(pixelRects.at(3).item, QRectF(6.0, 0.0, 0.0, 100.0));
+}
+
+TEST(FlexTileGeometryTest, RebuildAndMoveDoNotAllocateInSteadyState)
+{
+    FlexTileGeometry geometry;
+    std::mt19937 rng(4);
+    for (int n = 0; n < 50; ++n) {
+        const size_t index = rng() % geometry.count();
+        const auto orientation = rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical;
+        geometry.split(index, orientation, 1 + rng() % 2, {});
+    }
+    const auto rects = geometry.tileRects();
+
+    // The first rebuild may grow the buffers.
+    geometry.loadTiles(rects);
+    size_t start = allocationCount();
+    geometry.loadTiles(rects);
+    EXPECT_EQ(allocationCount() - start, 0u) << "allocations per rebuild";
+
+    size_t index = 0;
+    while (geometry.tileRectAt(index).x0 == 0.0) {
+        ++index;
+    }
+    const auto &rect = geometry.tileRectAt(index);
+    const qreal x = rect.x0;
+    const qreal delta = (rect.x1 - rect.x0) / 4;
+    geometry.startMoving(index, Qt::Horizontal, false, unitRect, { 0.0, 0.0 });
+    geometry.moveTo({ x + delta, 0.0 }, {});
+    geometry.moveTo({ x - delta, 0.0 }, {});
+    start = allocationCount();
+    for (int n = 0; n < 10; ++n) {
+        geometry.moveTo({ x + delta, 0.0 }, {});
+        geometry.moveTo({ x - delta, 0.0 }, {});
+    }
+    EXPECT_EQ(allocationCount() - start, 0u) << "allocations per move";
+    geometry.resetMovingState();
+}
@@ -9,12 +9,7 @@ constexpr QRectF unitRect { 0.0, 0.0, 1.0, 1.0 };
 
 std::vector<Tile> createTiles(size_t count)
 {
-    std::vector<Tile> tiles;
-    tiles.reserve(count);
-    for (size_t i = 0; i < count; ++i) {
-        tiles.push_back({ { 0.0, 0.0, 0.0, 0.0 }, {}, {}, {}, {}, {}, {} });
-    }
-    return tiles;
+    return std::vector<Tile>(count);
 }
 
 void moveBorder(FlexTileLayouter &layouter, size_t index, Qt::Orientations orientations,
@@ -26,374 +21,173 @@ void moveBorder(FlexTileLayouter &layouter, size_t index, Qt::Orientations orien
 }
 }
 
-TEST(FlexTileLayouterTest, Initial)
+TEST(FlexTileLayouterTest, CloseTakesTile)
 {
-    FlexTileLayouter layouter;
-    ASSERT_EQ(layouter.count(), 1);
+    auto tiles = createTiles(1);
+    auto *item = new QQuickItem;
+    tiles.front().item.reset(item);
 
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, SplitH2)
-{
     FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), {});
+    layouter.split(0, Qt::Horizontal, std::move(tiles), {});
     ASSERT_EQ(layouter.count(), 2);
 
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, 1.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.x0, 0.5);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, SplitV2)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y1, 1.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.y0, 0.5);
-}
-
-TEST(FlexTileLayouterTest, Split3x3)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(2), { 0.1, 0.1 });
-    layouter.split(0, Qt::Vertical, createTiles(2), { 0.1, 0.1 });
-    layouter.split(3, Qt::Vertical, createTiles(2), { 0.1, 0.1 });
-    layouter.split(6, Qt::Vertical, createTiles(2), { 0.1, 0.1 });
-    ASSERT_EQ(layouter.count(), 9);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(2).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(3).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, layouter.tileAt(4).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(2).normRect.x1, layouter.tileAt(5).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(3).normRect.x1, layouter.tileAt(6).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(4).normRect.x1, layouter.tileAt(7).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(5).normRect.x1, layouter.tileAt(8).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(6).normRect.x1, 1.0);
-    EXPECT_EQ(layouter.tileAt(7).normRect.x1, 1.0);
-    EXPECT_EQ(layouter.tileAt(8).normRect.x1, 1.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(3).normRect.x0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(4).normRect.x0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(5).normRect.x0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(6).normRect.x0, 2.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(7).normRect.x0, 2.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(8).normRect.x0, 2.0 / 3.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(3).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(6).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(3).normRect.y1, layouter.tileAt(4).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(6).normRect.y1, layouter.tileAt(7).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y1, layouter.tileAt(2).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(4).normRect.y1, layouter.tileAt(5).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(7).normRect.y1, layouter.tileAt(8).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(2).normRect.y1, 1.0);
-    EXPECT_EQ(layouter.tileAt(5).normRect.y1, 1.0);
-    EXPECT_EQ(layouter.tileAt(8).normRect.y1, 1.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.y0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(4).normRect.y0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(7).normRect.y0, 1.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(2).normRect.y0, 2.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(5).normRect.y0, 2.0 / 3.0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(8).normRect.y0, 2.0 / 3.0);
-}
-
-TEST(FlexTileLayouterTest, Close1)
-{
-    FlexTileLayouter layouter;
-    ASSERT_EQ(layouter.count(), 1);
-
-    const int collapsedToIndex = layouter.close(0);
-    ASSERT_EQ(layouter.count(), 1);
-    EXPECT_EQ(collapsedToIndex, -1);
-}
-
-TEST(FlexTileLayouterTest, Close2ToLeft)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    const int collapsedToIndex = layouter.close(1);
-    ASSERT_EQ(layouter.count(), 1);
-    EXPECT_EQ(collapsedToIndex, 0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, Close2ToRight)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    const int collapsedToIndex = layouter.close(0);
-    ASSERT_EQ(layouter.count(), 1);
-    EXPECT_EQ(collapsedToIndex, 0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, Close2ToTop)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    const int collapsedToIndex = layouter.close(1);
+    Tile closedTile;
+    const int collapsedToIndex = layouter.close(1, &closedTile);
     ASSERT_EQ(layouter.count(), 1);
     EXPECT_EQ(collapsedToIndex, 0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
+    EXPECT_EQ(closedTile.item.get(), item);
 }
 
-TEST(FlexTileLayouterTest, Close2ToBottom)
+TEST(FlexTileLayouterTest, TileIdsAreStable)
 {
     FlexTileLayouter layouter;
-    layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    const int collapsedToIndex = layouter.close(0);
-    ASSERT_EQ(layouter.count(), 1);
-    EXPECT_EQ(collapsedToIndex, 0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
+    layouter.split(0, Qt::Horizontal, createTiles(2), {});
+    ASSERT_EQ(layouter.count(), 3);
+    const size_t id0 = layouter.tileIdAt(0);
+    const size_t id2 = layouter.tileIdAt(2);
+    const auto *tile2 = &layouter.tileAt(2);
 
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, MoveH2)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), {});
+    const size_t closedId = layouter.tileIdAt(1);
+    layouter.close(1);
     ASSERT_EQ(layouter.count(), 2);
+    EXPECT_EQ(layouter.tileIdAt(0), id0);
+    EXPECT_EQ(layouter.tileIdAt(1), id2);
+    EXPECT_EQ(&layouter.tileAt(1), tile2);
 
-    layouter.startMoving(1, Qt::Horizontal, false, unitRect, {});
-    EXPECT_TRUE(layouter.isMoving());
-
-    layouter.moveTo({ 0.2, 0.0 }, {});
-    EXPECT_TRUE(layouter.isMoving());
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 0.2);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x0, 0.2);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-
-    layouter.moveTo({ 0.7, 0.0 }, {});
-    layouter.resetMovingState();
-    EXPECT_FALSE(layouter.isMoving());
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 0.7);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x0, 0.7);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, MoveV2)
-{
-    FlexTileLayouter layouter;
+    // The slot of the closed tile should be reused.
     layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    layouter.startMoving(1, Qt::Vertical, false, unitRect, {});
-    EXPECT_TRUE(layouter.isMoving());
-
-    layouter.moveTo({ 0.0, 0.3 }, {});
-    EXPECT_TRUE(layouter.isMoving());
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 0.3);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y0, 0.3);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y1, 1.0);
-
-    layouter.moveTo({ 0.0, 0.8 }, {});
-    layouter.resetMovingState();
-    EXPECT_FALSE(layouter.isMoving());
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, 1.0);
-
-    EXPECT_EQ(layouter.tileAt(0).normRect.y0, 0.0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, 0.8);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y0, 0.8);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y1, 1.0);
-}
-
-TEST(FlexTileLayouterTest, MoveH2Clamped)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
+    ASSERT_EQ(layouter.count(), 3);
+    EXPECT_EQ(layouter.tileIdAt(0), id0);
+    EXPECT_EQ(layouter.tileIdAt(1), closedId);
+    EXPECT_EQ(layouter.tileIdAt(2), id2);
+    EXPECT_EQ(&layouter.tileAt(2), tile2);
+}
+
+TEST(FlexTileLayouterTest, ResizeTilesSkipsUnchangedItems)
+{
+    const auto createTilesWithItems = [](size_t count) {
+        auto tiles = createTiles(count);
+        for (auto &t : tiles) {
+            t.item.reset(new QQuickItem);
+        }
+        return tiles;
+    };
+    const auto createHandleItem = [](Qt::Orientation) {
+        return std::tuple(FlexTileLayouter::UniqueItemPtr(new QQuickItem),
+                          std::unique_ptr<QQmlContext>());
+    };
+
+    FlexTileLayouter layouter;
+    layouter.replaceTileItem(0, FlexTileLayouter::UniqueItemPtr(new QQuickItem), {}, nullptr);
+    layouter.split(0, Qt::Horizontal, createTilesWithItems(2), {});
+    ASSERT_EQ(layouter.count(), 3);
+
+    // 3 tiles and 2 visible horizontal handles.
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(layouter.updatedItemCount(), 5);
+    EXPECT_EQ(layouter.tileAt(1).item->x(), 100.0);
+    EXPECT_EQ(layouter.tileAt(1).item->width(), 100.0);
+    EXPECT_TRUE(layouter.tileAt(2).horizontalHandleItem->isVisible());
+
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(layouter.updatedItemCount(), 0);
+
+    // Tiles on both sides of the border and the handle.
+    moveBorder(layouter, 2, Qt::Horizontal, { 0.5, 0.0 }, { 0.0, 0.0 });
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(layouter.updatedItemCount(), 3);
+    EXPECT_EQ(layouter.tileAt(1).item->width(), 50.0);
+    EXPECT_EQ(layouter.tileAt(2).item->x(), 150.0);
+    EXPECT_EQ(layouter.tileAt(2).horizontalHandleItem->x(), 150.0);
+}
+
+TEST(FlexTileLayouterTest, ResizeTilesCreatesVisibleHandlesOnly)
+{
+    int createdCount = 0;
+    const auto createHandleItem = [&createdCount](Qt::Orientation) {
+        ++createdCount;
+        return std::tuple(FlexTileLayouter::UniqueItemPtr(new QQuickItem),
+                          std::unique_ptr<QQmlContext>());
+    };
+
+    FlexTileLayouter layouter;
+    layouter.split(0, Qt::Horizontal, createTiles(2), {});
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(createdCount, 2);
+    EXPECT_FALSE(layouter.tileAt(0).horizontalHandleItem);
+    EXPECT_FALSE(layouter.tileAt(0).verticalHandleItem);
+    EXPECT_TRUE(layouter.tileAt(1).horizontalHandleItem);
+    EXPECT_FALSE(layouter.tileAt(1).verticalHandleItem);
+    EXPECT_TRUE(layouter.tileAt(2).horizontalHandleItem);
+    EXPECT_FALSE(layouter.tileAt(2).verticalHandleItem);
+
+    // Handle of the closed tile should be parked and reused.
+    layouter.close(2);
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    layouter.split(1, Qt::Horizontal, createTiles(1), {});
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(createdCount, 2);
+    EXPECT_TRUE(layouter.tileAt(2).horizontalHandleItem);
+    EXPECT_TRUE(layouter.tileAt(2).horizontalHandleItem->isVisible());
 
-    moveBorder(layouter, 1, Qt::Horizontal, { 0.0, 0.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x0);
-    EXPECT_NEAR(layouter.tileAt(0).normRect.x1, 0.1, 0.00001);
-    EXPECT_NEAR(layouter.tileAt(1).normRect.x0, 0.1, 0.00001);
-
-    moveBorder(layouter, 1, Qt::Horizontal, { 1.0, 1.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x0);
-    EXPECT_NEAR(layouter.tileAt(0).normRect.x1, 0.9, 0.00001);
-    EXPECT_NEAR(layouter.tileAt(1).normRect.x0, 0.9, 0.00001);
-}
-
-TEST(FlexTileLayouterTest, MoveV2Clamped)
-{
-    FlexTileLayouter layouter;
     layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    moveBorder(layouter, 1, Qt::Vertical, { 0.0, 0.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_NEAR(layouter.tileAt(0).normRect.y1, 0.1, 0.00001);
-    EXPECT_NEAR(layouter.tileAt(1).normRect.y0, 0.1, 0.00001);
-
-    moveBorder(layouter, 1, Qt::Vertical, { 1.0, 1.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_NEAR(layouter.tileAt(0).normRect.y1, 0.9, 0.00001);
-    EXPECT_NEAR(layouter.tileAt(1).normRect.y0, 0.9, 0.00001);
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    EXPECT_EQ(createdCount, 3);
+    EXPECT_TRUE(layouter.tileAt(1).verticalHandleItem);
+
+    // Handle of the closed tile should be released.
+    layouter.close(1);
+    layouter.resizeTiles({ 0.0, 0.0, 300.0, 100.0 }, { 0.0, 0.0 }, createHandleItem);
+    for (size_t i = 0; i < layouter.count(); ++i) {
+        EXPECT_FALSE(layouter.tileAt(i).verticalHandleItem);
+    }
 }
 
-TEST(FlexTileLayouterTest, MoveH2Epsilon)
+TEST(FlexTileLayouterTest, ApplyPixelRectsOfGeometryCopy)
 {
     FlexTileLayouter layouter;
+    layouter.replaceTileItem(0, FlexTileLayouter::UniqueItemPtr(new QQuickItem), {}, nullptr);
     layouter.split(0, Qt::Horizontal, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    moveBorder(layouter, 1, Qt::Horizontal, { 0.0, 0.0 }, { 0.0, 0.0 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x0);
-    EXPECT_LT(layouter.tileAt(0).normRect.x0, layouter.tileAt(0).normRect.x1);
-    EXPECT_LT(layouter.tileAt(1).normRect.x0, layouter.tileAt(1).normRect.x1);
-
-    moveBorder(layouter, 1, Qt::Horizontal, { 1.0, 1.0 }, { 0.0, 0.0 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x0);
-    EXPECT_LT(layouter.tileAt(0).normRect.x0, layouter.tileAt(0).normRect.x1);
-    EXPECT_LT(layouter.tileAt(1).normRect.x0, layouter.tileAt(1).normRect.x1);
-}
-
-TEST(FlexTileLayouterTest, MoveV2Epsilon)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Vertical, createTiles(1), {});
-    ASSERT_EQ(layouter.count(), 2);
-
-    moveBorder(layouter, 1, Qt::Vertical, { 0.0, 0.0 }, { 0.0, 0.0 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_LT(layouter.tileAt(0).normRect.y0, layouter.tileAt(0).normRect.y1);
-    EXPECT_LT(layouter.tileAt(1).normRect.y0, layouter.tileAt(1).normRect.y1);
-
-    moveBorder(layouter, 1, Qt::Vertical, { 1.0, 1.0 }, { 0.0, 0.0 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_LT(layouter.tileAt(0).normRect.y0, layouter.tileAt(0).normRect.y1);
-    EXPECT_LT(layouter.tileAt(1).normRect.y0, layouter.tileAt(1).normRect.y1);
-}
-
-TEST(FlexTileLayouterTest, MoveHV2x2)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), { 0.1, 0.1 });
-    layouter.split(0, Qt::Vertical, createTiles(1), { 0.1, 0.1 });
-    layouter.split(2, Qt::Vertical, createTiles(1), { 0.1, 0.1 });
-    ASSERT_EQ(layouter.count(), 4);
-
-    // All borders are isolated at this moment.
-    moveBorder(layouter, 3, Qt::Horizontal, { 0.4, 0.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(2).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, layouter.tileAt(3).normRect.x0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(0).normRect.x1, 0.5);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.x1, 0.4);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(2).normRect.x0, 0.5);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(3).normRect.x0, 0.4);
-
-    // Vertical border should get unisolated.
-    moveBorder(layouter, 1, Qt::Vertical, { 0.0, 0.6 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(2).normRect.y1, layouter.tileAt(3).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(2).normRect.y1);
-    EXPECT_EQ(layouter.tileAt(1).normRect.y0, layouter.tileAt(3).normRect.y0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(0).normRect.y1, 0.6);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.y0, 0.6);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(2).normRect.y1, 0.6);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(3).normRect.y0, 0.6);
-}
-
-TEST(FlexTileLayouterTest, MoveVH2x2)
-{
-    FlexTileLayouter layouter;
-    layouter.split(0, Qt::Horizontal, createTiles(1), { 0.1, 0.1 });
-    layouter.split(0, Qt::Vertical, createTiles(1), { 0.1, 0.1 });
-    layouter.split(2, Qt::Vertical, createTiles(1), { 0.1, 0.1 });
-    ASSERT_EQ(layouter.count(), 4);
-
-    // All borders are isolated at this moment.
-    moveBorder(layouter, 1, Qt::Vertical, { 0.0, 0.3 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.y1, layouter.tileAt(1).normRect.y0);
-    EXPECT_EQ(layouter.tileAt(2).normRect.y1, layouter.tileAt(3).normRect.y0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(0).normRect.y1, 0.3);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.y0, 0.3);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(2).normRect.y1, 0.5);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(3).normRect.y0, 0.5);
-
-    // Horizontal border should get unisolated.
-    moveBorder(layouter, 2, Qt::Horizontal, { 0.8, 0.0 }, { 0.1, 0.1 });
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(2).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(1).normRect.x1, layouter.tileAt(3).normRect.x0);
-    EXPECT_EQ(layouter.tileAt(0).normRect.x1, layouter.tileAt(1).normRect.x1);
-    EXPECT_EQ(layouter.tileAt(2).normRect.x0, layouter.tileAt(3).normRect.x0);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(0).normRect.x1, 0.8);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(1).normRect.x1, 0.8);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(2).normRect.x0, 0.8);
-    EXPECT_DOUBLE_EQ(layouter.tileAt(3).normRect.x0, 0.8);
+    layouter.replaceTileItem(1, FlexTileLayouter::UniqueItemPtr(new QQuickItem), {}, nullptr);
+
+    // Calculated from copy as if it were done in worker thread.
+    FlexTileGeometry geometry;
+    geometry.assignTiles(layouter.geometry());
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    geometry.calculatePixelRects({ 0.0, 0.0, 200.0, 100.0 }, { 0.0, 0.0 }, pixelRects);
+
+    // Moved while calculating. The items should be placed at the copied layout.
+    moveBorder(layouter, 1, Qt::Horizontal, { 0.25, 0.0 }, { 0.0, 0.0 });
+    ASSERT_EQ(geometry.indexRevision(), layouter.geometry().indexRevision());
+    EXPECT_NE(geometry.revision(), layouter.geometry().revision());
+    layouter.applyPixelRects(geometry, pixelRects);
+    EXPECT_EQ(layouter.updatedItemCount(), 2);
+    EXPECT_EQ(layouter.tileAt(1).item->x(), 100.0);
+    EXPECT_EQ(layouter.geometry().tileRectAt(1).x0, 0.25);
+
+    layouter.resizeTiles({ 0.0, 0.0, 200.0, 100.0 }, { 0.0, 0.0 });
+    EXPECT_EQ(layouter.tileAt(1).item->x(), 50.0);
+}
+
+TEST(FlexTileLayouterTest, HideUnplacedItemsUntilApplied)
+{
+    FlexTileLayouter layouter;
+    layouter.replaceTileItem(0, FlexTileLayouter::UniqueItemPtr(new QQuickItem), {}, nullptr);
+    layouter.resizeTiles({ 0.0, 0.0, 200.0, 100.0 }, { 0.0, 0.0 });
+
+    auto tiles = createTiles(1);
+    tiles.front().item.reset(new QQuickItem);
+    layouter.split(0, Qt::Horizontal, std::move(tiles), {});
+    layouter.hideUnplacedItems();
+    EXPECT_TRUE(layouter.tileAt(0).item->isVisible());
+    EXPECT_FALSE(layouter.tileAt(1).item->isVisible());
+
+    // Calculated from copy as if it were done in worker thread.
+    FlexTileGeometry geometry;
+    geometry.assignTiles(layouter.geometry());
+    std::vector<FlexTileGeometry::PixelRects> pixelRects;
+    geometry.calculatePixelRects({ 0.0, 0.0, 200.0, 100.0 }, { 0.0, 0.0 }, pixelRects);
+    layouter.applyPixelRects(geometry, pixelRects);
+    EXPECT_TRUE(layouter.tileAt(1).item->isVisible());
+    EXPECT_EQ(layouter.tileAt(1).item->x(), 100.0);
 }
@@ -1,5 +1,36 @@
 #include <QCoreApplication>
+#include <atomic>
+#include <cstdlib>
 #include <gtest/gtest.h>
+#include <new>
+#include "testutil.h"
+
+namespace {
+std::atomic<size_t> allocations { 0 };
+}
+
+size_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
 
 int main(int argc, char *argv[])
 {
@@ -0,0 +1,5 @@
+#pragma once
+#include <cstddef>
+
+/// Number of global operator new calls made so far.
+size_t allocationCount();
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QtQml>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "tiler.h"
+
+namespace {
+/// Exposes the polish step and the mouse handlers to drive the tiler as the view would.
+class TestTiler : public Tiler
+{
+public:
+    using Tiler::mouseMoveEvent;
+    using Tiler::mousePressEvent;
+    using Tiler::mouseReleaseEvent;
+    using Tiler::updatePolish;
+};
+
+std::vector<QRectF> tileRects(const Tiler &tiler)
+{
+    std::vector<QRectF> rects;
+    for (int i = 0; i < tiler.count(); ++i) {
+        const auto *item = tiler.itemAt(i);
+        rects.emplace_back(item->position(), item->size());
+    }
+    return rects;
+}
+
+void setMinimumSize(Tiler &tiler, int tileIndex, const QSizeF &size)
+{
+    auto *a = qobject_cast<TilerAttached *>(
+            qmlAttachedPropertiesObject<Tiler>(tiler.itemAt(tileIndex)));
+    a->setMinimumWidth(size.width());
+    a->setMinimumHeight(size.height());
+}
+
+/// Drags a random handle item to a random position within the tiler.
+void moveRandomHandle(TestTiler &tiler, std::mt19937 &rng)
+{
+    std::vector<const QQuickItem *> tileItems;
+    for (int i = 0; i < tiler.count(); ++i) {
+        tileItems.push_back(tiler.itemAt(i));
+    }
+    std::vector<const QQuickItem *> handleItems;
+    for (const auto *item : tiler.childItems()) {
+        if (item->isVisible()
+            && std::find(tileItems.begin(), tileItems.end(), item) == tileItems.end()) {
+            handleItems.push_back(item);
+        }
+    }
+    if (handleItems.empty())
+        return;
+
+    const auto *item = handleItems.at(rng() % handleItems.size());
+    const QPointF pressPos = item->position() + QPointF(item->width(), item->height()) / 2.0;
+    const QPointF movePos(static_cast<qreal>(rng() % 401), static_cast<qreal>(rng() % 301));
+    QMouseEvent press(QEvent::MouseButtonPress, pressPos, pressPos, Qt::LeftButton,
+                      Qt::LeftButton, Qt::NoModifier);
+    QMouseEvent move(QEvent::MouseMove, movePos, movePos, Qt::NoButton, Qt::LeftButton,
+                     Qt::NoModifier);
+    QMouseEvent release(QEvent::MouseButtonRelease, movePos, movePos, Qt::LeftButton,
+                        Qt::NoButton, Qt::NoModifier);
+    tiler.mousePressEvent(&press);
+    tiler.mouseMoveEvent(&move);
+    tiler.mouseReleaseEvent(&release);
+}
+}
+
+TEST(TilerTest, RandomOperationsKeepSplitMapConsistent)
+{
+    QQmlEngine engine;
+    QQmlComponent delegate(&engine);
+    delegate.setData("import QtQuick\nItem {}", QUrl());
+    // Identical pairs of handles. Switching to the other pair lays out all splits
+    // from scratch, which the partial layout of the moved splits should match.
+    QQmlComponent horizontalHandles[2] = { QQmlComponent(&engine), QQmlComponent(&engine) };
+    QQmlComponent verticalHandles[2] = { QQmlComponent(&engine), QQmlComponent(&engine) };
+    for (auto &handle : horizontalHandles) {
+        handle.setData("import QtQuick\nItem { implicitWidth: 3; implicitHeight: 3 }", QUrl());
+    }
+    for (auto &handle : verticalHandles) {
+        handle.setData("import QtQuick\nItem { implicitWidth: 2; implicitHeight: 2 }", QUrl());
+    }
+
+    TestTiler tiler;
+    tiler.setDelegate(&delegate);
+    tiler.setHorizontalHandle(&horizontalHandles[0]);
+    tiler.setVerticalHandle(&verticalHandles[0]);
+    tiler.setSize({ 400.0, 300.0 });
+    tiler.updatePolish();
+
+    std::mt19937 rng(1);
+    int handleSet = 0;
+    for (int n = 0; n < 3000; ++n) {
+        const auto op = rng() % 9;
+        if (op < 3 && tiler.count() < 60) {
+            const int index = static_cast<int>(rng() % static_cast<size_t>(tiler.count()));
+            tiler.split(index, rng() % 2 == 0 ? Qt::Horizontal : Qt::Vertical);
+        } else if (op < 5 && tiler.count() > 1) {
+            tiler.close(static_cast<int>(rng() % static_cast<size_t>(tiler.count())));
+        } else if (op < 8) {
+            moveRandomHandle(tiler, rng);
+        } else {
+            const int index = static_cast<int>(rng() % static_cast<size_t>(tiler.count()));
+            setMinimumSize(tiler, index,
+                           { static_cast<qreal>(rng() % 30), static_cast<qreal>(rng() % 30) });
+        }
+        ASSERT_TRUE(tiler.verifySplitMap()) << n;
+
+        // Closing most of the tiles should compact the split map while some of the
+        // moved splits are pending.
+        if (n % 500 == 499) {
+            while (tiler.count() > 2) {
+                moveRandomHandle(tiler, rng);
+                tiler.close(static_cast<int>(rng() % static_cast<size_t>(tiler.count())));
+                ASSERT_TRUE(tiler.verifySplitMap()) << n;
+            }
+        }
+
+        if (rng() % 4 != 0)
+            continue;
+        tiler.updatePolish();
+        ASSERT_TRUE(tiler.verifySplitMap()) << n;
+        const auto rects = tileRects(tiler);
+        handleSet = 1 - handleSet;
+        tiler.setHorizontalHandle(&horizontalHandles[handleSet]);
+        tiler.setVerticalHandle(&verticalHandles[handleSet]);
+        tiler.updatePolish();
+        ASSERT_TRUE(tiler.verifySplitMap()) << n;
+        ASSERT_EQ(tileRects(tiler), rects) << n;
+    }
+}